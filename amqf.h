@@ -0,0 +1,571 @@
+#ifndef HOL_AMQF_H__INCLUDED
+#define HOL_AMQF_H__INCLUDED 1
+/*
+MIT License
+
+Copyright (c) 2023 Tristan Styles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//------------------------------------------------------------------------------
+
+#include <hol/xtdlib.h>
+#include <hol/hash.h>
+#include <stdio.h>
+
+//------------------------------------------------------------------------------
+
+// AMQF: approximate membership query filters
+//
+//       Both filters are keyed by a 64-bit hash, e.g. from memhash, from which
+//       all of the bits they use are derived; a negative answer is definite,
+//       a positive answer is subject to the false positive rate the filter
+//       was sized for.
+
+// Blocked bloom filter: all of the bits for a key are in one 512-bit block,
+// i.e. one cache line.
+
+struct bloom {
+	size_t    n;
+	unsigned  k;
+	uint64_t *b;
+};
+
+extern struct bloom *new_bloom(size_t n, double p);
+extern void          del_bloom(struct bloom *bp);
+
+extern void bloom_add(struct bloom       *bp, uint64_t h);
+extern bool bloom_has(struct bloom const *bp, uint64_t h);
+
+extern bool          bloom_write(struct bloom const *bp, FILE *out);
+extern struct bloom *bloom_read (FILE *in);
+
+static inline void
+bloom_insert(
+	struct bloom *bp,
+	void const   *key,
+	size_t        len
+) {
+	bloom_add(bp, memhash(key, len));
+}
+
+static inline bool
+bloom_lookup(
+	struct bloom const *bp,
+	void   const       *key,
+	size_t              len
+) {
+	return bloom_has(bp, memhash(key, len));
+}
+
+// Quotient filter: a compact open-addressing table of hash remainders, in
+// runs sorted by quotient; adding fails when the filter is full.
+
+struct quotf {
+	unsigned  q;
+	unsigned  r;
+	size_t    n;
+	uint64_t *t;
+};
+
+extern struct quotf *new_quotf(size_t n, double p);
+extern void          del_quotf(struct quotf *qp);
+
+extern bool quotf_add(struct quotf       *qp, uint64_t h);
+extern bool quotf_has(struct quotf const *qp, uint64_t h);
+
+extern bool          quotf_write(struct quotf const *qp, FILE *out);
+extern struct quotf *quotf_read (FILE *in);
+
+static inline bool
+quotf_insert(
+	struct quotf *qp,
+	void const   *key,
+	size_t        len
+) {
+	return quotf_add(qp, memhash(key, len));
+}
+
+static inline bool
+quotf_lookup(
+	struct quotf const *qp,
+	void   const       *key,
+	size_t              len
+) {
+	return quotf_has(qp, memhash(key, len));
+}
+
+//------------------------------------------------------------------------------
+
+#endif//ndef HOL_AMQF_H__INCLUDED
+
+//------------------------------------------------------------------------------
+
+#ifdef HOL_AMQF_H__IMPLEMENTATION
+#undef HOL_AMQF_H__IMPLEMENTATION
+
+//------------------------------------------------------------------------------
+
+#include <hol/lebe.h>
+#include <errno.h>
+#include <string.h>
+#include <math.h>
+
+//------------------------------------------------------------------------------
+
+// keys may be masked hashes, so all 64 bits are remixed before use
+static inline uint64_t
+amqf__mix(
+	uint64_t x
+) {
+	x = (x ^ (x >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+	x = (x ^ (x >> 27)) * UINT64_C(0x94D049BB133111EB);
+	return x ^ (x >> 31);
+}
+
+static bool
+amqf__write(
+	char     const *magic,
+	uint64_t const  u[3],
+	size_t          n,
+	uint64_t const  t[n],
+	FILE           *out
+) {
+	uint8_t b[sizeof(uint64_t)];
+	if(fwrite(magic, 1, sizeof(b), out) != sizeof(b)) return false;
+	for(size_t i = 0; i < 3; i++) {
+		setu64le(u[i], b);
+		if(fwrite(b, 1, sizeof(b), out) != sizeof(b)) return false;
+	}
+	for(size_t i = 0; i < n; i++) {
+		setu64le(t[i], b);
+		if(fwrite(b, 1, sizeof(b), out) != sizeof(b)) return false;
+	}
+	return true;
+}
+
+static bool
+amqf__read_header(
+	char const *magic,
+	uint64_t    u[3],
+	FILE       *in
+) {
+	uint8_t b[sizeof(uint64_t)];
+	if((fread(b, 1, sizeof(b), in) != sizeof(b)) || (memcmp(b, magic, sizeof(b)) != 0)) return false;
+	for(size_t i = 0; i < 3; i++) {
+		if(fread(b, 1, sizeof(b), in) != sizeof(b)) return false;
+		u[i] = getu64le(b);
+	}
+	return true;
+}
+
+static bool
+amqf__read_table(
+	size_t    n,
+	uint64_t  t[n],
+	FILE     *in
+) {
+	uint8_t b[sizeof(uint64_t)];
+	for(size_t i = 0; i < n; i++) {
+		if(fread(b, 1, sizeof(b), in) != sizeof(b)) return false;
+		t[i] = getu64le(b);
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+
+enum {
+	BLOOM_BLOCK_BITS  = 512,
+	BLOOM_BLOCK_WORDS = BLOOM_BLOCK_BITS / 64,
+	BLOOM_MAX_K       = 16
+};
+
+static char const bloom__magic[sizeof(uint64_t)] = "BLOOM\0\1";
+
+static struct bloom *
+bloom__new(
+	size_t   n,
+	unsigned k
+) {
+	struct bloom *bp = malloc(sizeof(*bp));
+	if(likely(bp)) {
+		bp->n = n;
+		bp->k = k;
+		bp->b = calloc(n * BLOOM_BLOCK_WORDS, sizeof(*bp->b));
+		if(likely(bp->b)) return bp;
+		free(bp);
+	}
+	errno = ENOMEM;
+	return NULL;
+}
+
+struct bloom *
+new_bloom(
+	size_t n,
+	double p
+) {
+	if((p <= 0.0) || (p >= 1.0)) p = 0.01;
+	if(n < 1) n = 1;
+	// bits per key for a classic bloom filter, plus ~10% to make up for the
+	// uneven load of blocks
+	double const ln2 = 0.69314718055994530942;
+	double const c   = (-log(p) / (ln2 * ln2)) * 1.1;
+	unsigned     k   = (unsigned)((c * ln2) + 0.5);
+	if(k < 1) k = 1;
+	if(k > BLOOM_MAX_K) k = BLOOM_MAX_K;
+	double const m = ceil((c * (double)n) / BLOOM_BLOCK_BITS);
+	if(m > (double)UINT32_MAX) {
+		errno = ERANGE;
+		return NULL;
+	}
+	return bloom__new((size_t)m, k);
+}
+
+void
+del_bloom(
+	struct bloom *bp
+) {
+	if(bp) {
+		free(bp->b);
+		free(bp);
+	}
+}
+
+static inline uint64_t *
+bloom__block(
+	struct bloom const *bp,
+	uint64_t            x
+) {
+	size_t const i = (size_t)(((x >> 32) * (uint64_t)bp->n) >> 32);
+	return bp->b + (i * BLOOM_BLOCK_WORDS);
+}
+
+void
+bloom_add(
+	struct bloom *bp,
+	uint64_t      h
+) {
+	uint64_t const x = amqf__mix(h);
+	uint64_t const y = x * UINT64_C(0x9E3779B97F4A7C15);
+	uint64_t      *b = bloom__block(bp, x);
+	uint32_t       u = (uint32_t)x;
+	uint32_t const v = (uint32_t)(y >> 32) | 1;
+	for(unsigned i = 0; i < bp->k; i++, u += v) {
+		unsigned const j = u % BLOOM_BLOCK_BITS;
+		b[j / 64] |= UINT64_C(1) << (j % 64);
+	}
+}
+
+bool
+bloom_has(
+	struct bloom const *bp,
+	uint64_t            h
+) {
+	uint64_t const  x = amqf__mix(h);
+	uint64_t const  y = x * UINT64_C(0x9E3779B97F4A7C15);
+	uint64_t const *b = bloom__block(bp, x);
+	uint32_t        u = (uint32_t)x;
+	uint32_t const  v = (uint32_t)(y >> 32) | 1;
+	for(unsigned i = 0; i < bp->k; i++, u += v) {
+		unsigned const j = u % BLOOM_BLOCK_BITS;
+		if(!(b[j / 64] & (UINT64_C(1) << (j % 64)))) return false;
+	}
+	return true;
+}
+
+bool
+bloom_write(
+	struct bloom const *bp,
+	FILE               *out
+) {
+	uint64_t const u[3] = { bp->n, bp->k, 0 };
+	return amqf__write(bloom__magic, u, bp->n * BLOOM_BLOCK_WORDS, bp->b, out);
+}
+
+struct bloom *
+bloom_read(
+	FILE *in
+) {
+	uint64_t u[3];
+	if(amqf__read_header(bloom__magic, u, in)
+		&& (u[0] > 0) && (u[0] <= UINT32_MAX)
+		&& (u[1] > 0) && (u[1] <= BLOOM_MAX_K)
+	) {
+		struct bloom *bp = bloom__new(u[0], u[1]);
+		if(bp) {
+			if(amqf__read_table(bp->n * BLOOM_BLOCK_WORDS, bp->b, in)) return bp;
+			del_bloom(bp);
+		}
+	}
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+
+// Slots are packed r+3 bits apiece: bit 0 is-occupied, bit 1 is-continuation,
+// bit 2 is-shifted, and bits 3.. the remainder; the table is a ring of 2**q
+// slots.
+
+enum {
+	QUOTF_OCCUPIED     = 1,
+	QUOTF_CONTINUATION = 2,
+	QUOTF_SHIFTED      = 4,
+	QUOTF_METADATA     = 7,
+	QUOTF_MAX_LOAD     = 15, // sixteenths
+	QUOTF_MAX_R        = 61  // so a slot of r + 3 bits fits in 64
+};
+
+static char const quotf__magic[sizeof(uint64_t)] = "QUOTF\0\1";
+
+static inline size_t   quotf__size (struct quotf const *qp) { return (size_t)1 << qp->q; }
+static inline unsigned quotf__bits (struct quotf const *qp) { return qp->r + 3; }
+static inline size_t   quotf__words(struct quotf const *qp) { return ((quotf__size(qp) * quotf__bits(qp)) + 63) / 64; }
+static inline size_t   quotf__incr (struct quotf const *qp, size_t i) { return (i + 1) & (quotf__size(qp) - 1); }
+static inline size_t   quotf__decr (struct quotf const *qp, size_t i) { return (i - 1) & (quotf__size(qp) - 1); }
+
+static inline uint64_t
+quotf__get(
+	struct quotf const *qp,
+	size_t              i
+) {
+	unsigned const z = quotf__bits(qp);
+	uint64_t const m = UINT64_MAX >> (64 - z);
+	size_t   const o = i * z;
+	size_t   const w = o / 64;
+	unsigned const b = o % 64;
+	uint64_t       e = qp->t[w] >> b;
+	if((b + z) > 64) e |= qp->t[w + 1] << (64 - b);
+	return e & m;
+}
+
+static inline void
+quotf__set(
+	struct quotf *qp,
+	size_t        i,
+	uint64_t      e
+) {
+	unsigned const z = quotf__bits(qp);
+	uint64_t const m = UINT64_MAX >> (64 - z);
+	size_t   const o = i * z;
+	size_t   const w = o / 64;
+	unsigned const b = o % 64;
+	qp->t[w] = (qp->t[w] & ~(m << b)) | (e << b);
+	if((b + z) > 64) {
+		unsigned const s = 64 - b;
+		qp->t[w + 1] = (qp->t[w + 1] & ~(m >> s)) | (e >> s);
+	}
+}
+
+static inline bool is_quotf_occupied    (uint64_t e) { return (e & QUOTF_OCCUPIED) != 0; }
+static inline bool is_quotf_continuation(uint64_t e) { return (e & QUOTF_CONTINUATION) != 0; }
+static inline bool is_quotf_shifted     (uint64_t e) { return (e & QUOTF_SHIFTED) != 0; }
+static inline bool is_quotf_empty       (uint64_t e) { return (e & QUOTF_METADATA) == 0; }
+
+static inline void
+quotf__split(
+	struct quotf const *qp,
+	uint64_t            h,
+	size_t             *fq,
+	uint64_t           *fr
+) {
+	uint64_t const x = amqf__mix(h);
+	*fr = x & ((UINT64_C(1) << qp->r) - 1);
+	*fq = (size_t)(x >> qp->r) & (quotf__size(qp) - 1);
+}
+
+static size_t
+quotf__run(
+	struct quotf const *qp,
+	size_t              fq
+) {
+	// find the start of the cluster, then step over a run for each occupied
+	// slot before fq
+	size_t b = fq;
+	while(is_quotf_shifted(quotf__get(qp, b))) {
+		b = quotf__decr(qp, b);
+	}
+	size_t s = b;
+	while(b != fq) {
+		do s = quotf__incr(qp, s);
+		while(is_quotf_continuation(quotf__get(qp, s)));
+		do b = quotf__incr(qp, b);
+		while(!is_quotf_occupied(quotf__get(qp, b)));
+	}
+	return s;
+}
+
+static struct quotf *
+quotf__new(
+	unsigned q,
+	unsigned r
+) {
+	struct quotf *qp = malloc(sizeof(*qp));
+	if(likely(qp)) {
+		qp->q = q;
+		qp->r = r;
+		qp->n = 0;
+		qp->t = calloc(quotf__words(qp), sizeof(*qp->t));
+		if(likely(qp->t)) return qp;
+		free(qp);
+	}
+	errno = ENOMEM;
+	return NULL;
+}
+
+struct quotf *
+new_quotf(
+	size_t n,
+	double p
+) {
+	if((p <= 0.0) || (p >= 1.0)) p = 0.01;
+	if(n < 1) n = 1;
+	unsigned q = 1;
+	while((q < 48) && ((((size_t)1 << q) / 16) * QUOTF_MAX_LOAD < n)) q++;
+	unsigned r = (unsigned)ceil(-log2(p));
+	if(r < 1) r = 1;
+	if((q + r) > 64) r = 64 - q;
+	if(r > QUOTF_MAX_R) r = QUOTF_MAX_R;
+	return quotf__new(q, r);
+}
+
+void
+del_quotf(
+	struct quotf *qp
+) {
+	if(qp) {
+		free(qp->t);
+		free(qp);
+	}
+}
+
+bool
+quotf_has(
+	struct quotf const *qp,
+	uint64_t            h
+) {
+	size_t   fq;
+	uint64_t fr;
+	quotf__split(qp, h, &fq, &fr);
+	if(!is_quotf_occupied(quotf__get(qp, fq))) return false;
+
+	size_t s = quotf__run(qp, fq);
+	do {
+		uint64_t const e = quotf__get(qp, s) >> 3;
+		if(e == fr) return true;
+		if(e >  fr) return false;
+		s = quotf__incr(qp, s);
+	} while(is_quotf_continuation(quotf__get(qp, s)));
+	return false;
+}
+
+bool
+quotf_add(
+	struct quotf *qp,
+	uint64_t      h
+) {
+	if(qp->n >= ((quotf__size(qp) / 16) * QUOTF_MAX_LOAD)) return false;
+
+	size_t   fq;
+	uint64_t fr;
+	quotf__split(qp, h, &fq, &fr);
+	uint64_t const t = quotf__get(qp, fq);
+	uint64_t       e = fr << 3;
+
+	if(is_quotf_empty(t)) {
+		quotf__set(qp, fq, e | QUOTF_OCCUPIED);
+		qp->n++;
+		return true;
+	}
+
+	if(!is_quotf_occupied(t)) {
+		quotf__set(qp, fq, t | QUOTF_OCCUPIED);
+	}
+
+	size_t const start = quotf__run(qp, fq);
+	size_t       s     = start;
+	if(is_quotf_occupied(t)) {
+		// keep runs sorted, so that lookups can stop early
+		do {
+			uint64_t const u = quotf__get(qp, s) >> 3;
+			if(u == fr) return true;
+			if(u >  fr) break;
+			s = quotf__incr(qp, s);
+		} while(is_quotf_continuation(quotf__get(qp, s)));
+
+		if(s == start) {
+			quotf__set(qp, start, quotf__get(qp, start) | QUOTF_CONTINUATION);
+		} else {
+			e |= QUOTF_CONTINUATION;
+		}
+	}
+	if(s != fq) {
+		e |= QUOTF_SHIFTED;
+	}
+
+	// shift the remainder of the cluster right by one slot; is-occupied
+	// belongs to the slot, not to the remainder
+	for(bool empty = false; !empty; s = quotf__incr(qp, s)) {
+		uint64_t u = quotf__get(qp, s);
+		if(!(empty = is_quotf_empty(u))) {
+			u |= QUOTF_SHIFTED;
+			if(is_quotf_occupied(u)) {
+				e |=  QUOTF_OCCUPIED;
+				u &= ~(uint64_t)QUOTF_OCCUPIED;
+			}
+		}
+		quotf__set(qp, s, e);
+		e = u;
+	}
+	qp->n++;
+	return true;
+}
+
+bool
+quotf_write(
+	struct quotf const *qp,
+	FILE               *out
+) {
+	uint64_t const u[3] = { qp->q, qp->r, qp->n };
+	return amqf__write(quotf__magic, u, quotf__words(qp), qp->t, out);
+}
+
+struct quotf *
+quotf_read(
+	FILE *in
+) {
+	uint64_t u[3];
+	if(amqf__read_header(quotf__magic, u, in)
+		&& (u[0] > 0) && (u[0] <= 48)
+		&& (u[1] > 0) && (u[1] <= QUOTF_MAX_R) && ((u[0] + u[1]) <= 64)
+	) {
+		struct quotf *qp = quotf__new(u[0], u[1]);
+		if(qp) {
+			qp->n = u[2];
+			if(amqf__read_table(quotf__words(qp), qp->t, in)) return qp;
+			del_quotf(qp);
+		}
+	}
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+
+#endif//def HOL_AMQF_H__IMPLEMENTATION
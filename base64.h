@@ -120,6 +120,30 @@ static inline int base64decode(size_t n, char k[n], char const *cs, int wrap) {
 
 //------------------------------------------------------------------------------
 
+// BASE64_STREAM: incremental transcoding of bytes, with the bits of a partial
+//                group carried from one chunk to the next. Encoding is flushed
+//                by base64_encode_final, which, as base64encode, does not pad;
+//                decoding skips any character that is not base 64, and drops
+//                the bits of a trailing partial byte.
+
+struct base64_stream {
+	uint32_t u;
+	unsigned b;
+};
+#define BASE64_STREAM(...)  { .u = 0, .b = 0 }
+
+// encoding n bytes writes at most base64enclen(n + 2) chars
+extern size_t base64_encode_update(struct base64_stream *st, char *cs, void const *p, size_t n);
+extern size_t base64_encode_final (struct base64_stream *st, char *cs);
+
+// decodes up to *np bytes, and returns the number of chars used
+extern size_t base64_decode_update(struct base64_stream *st, void *p, size_t *np, char const *cs, size_t m);
+
+// the number of base 64 chars in cs[0..m), which decode to (n * 3) / 4 bytes
+extern size_t base64_count(char const *cs, size_t m);
+
+//------------------------------------------------------------------------------
+
 #endif//ndef HOL_BASE64_H__INCLUDED
 
 //------------------------------------------------------------------------------
@@ -128,6 +152,12 @@ static inline int base64decode(size_t n, char k[n], char const *cs, int wrap) {
 
 //------------------------------------------------------------------------------
 
+#include <hol/xtdlib.h>
+#include <hol/simd.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+
 static const char base64__chars[64] = {
 	'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
 	'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
@@ -202,6 +232,301 @@ base64__dechar(
 
 static inline uint64_t base64__mask64(int n) { return ~(~UINT64_C(0) << n); }
 
+static inline bool
+base64__ready(
+	void
+) {
+#if !(BASE64__ASCII_MAP || BASE64__UTF8_MAP)
+	return base64__mapsize || (base64__initialize() == 0);
+#else
+	return true;
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+// SIMD kernels for bytes, after Mula and Lemire: 12 bytes are spread over the
+// 16 lanes of 6 bit indices, which are then offset into the alphabet; and in
+// reverse, after checking the chars are in the alphabet. They need 16 bytes,
+// or 28 with AVX2, readable from the input, and as many writable when
+// decoding; and return the number of bytes, or chars, done, which is none
+// when the processor lacks SSSE3.
+
+#if defined(SIMD_SSSE3) && ('A' == 0x41)
+#	define BASE64__SIMD  (1)
+
+static inline simd_ssse3 __m128i
+base64__enc128(
+	__m128i in
+) {
+	in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+	__m128i const t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+	__m128i const t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+	__m128i const ix = _mm_or_si128(t0, t1);
+	__m128i       r  = _mm_subs_epu8(ix, _mm_set1_epi8(51));
+	r = _mm_or_si128(r, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), ix), _mm_set1_epi8(13)));
+	r = _mm_shuffle_epi8(_mm_setr_epi8(
+		'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0
+	), r);
+	return _mm_add_epi8(r, ix);
+}
+
+static inline simd_ssse3 unsigned
+base64__invalid128(
+	__m128i  in,
+	__m128i *hip
+) {
+	// a bit for each char that is not in the alphabet
+	__m128i const hi = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0F));
+	__m128i const lo = _mm_and_si128(in, _mm_set1_epi8(0x0F));
+	__m128i const lx = _mm_shuffle_epi8(_mm_setr_epi8(
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+	), lo);
+	__m128i const hx = _mm_shuffle_epi8(_mm_setr_epi8(
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+	), hi);
+	*hip = hi;
+	return (unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lx, hx), _mm_setzero_si128()));
+}
+
+static inline simd_ssse3 bool
+base64__dec128(
+	__m128i  in,
+	__m128i *out
+) {
+	__m128i hi;
+	if(base64__invalid128(in, &hi)) {
+		return false;
+	}
+	__m128i const roll = _mm_shuffle_epi8(_mm_setr_epi8(
+		0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+	), _mm_add_epi8(_mm_cmpeq_epi8(in, _mm_set1_epi8('/')), hi));
+	__m128i v = _mm_add_epi8(in, roll);
+	v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+	v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+	*out = _mm_shuffle_epi8(v, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+	return true;
+}
+
+static simd_ssse3 size_t
+base64__encode_ssse3(
+	char          *cs,
+	uint8_t const *p,
+	size_t         n
+) {
+	size_t i = 0;
+	for(; (i + 16) <= n; i += 12, cs += 16) {
+		_mm_storeu_si128((__m128i *)cs, base64__enc128(_mm_loadu_si128((__m128i const *)(p + i))));
+	}
+	return i;
+}
+
+#if defined(SIMD_AVX2)
+static simd_avx2 size_t
+base64__encode_avx2(
+	char          *cs,
+	uint8_t const *p,
+	size_t         n
+) {
+	size_t i = 0;
+	for(; (i + 28) <= n; i += 24, cs += 32) {
+		__m128i const a = base64__enc128(_mm_loadu_si128((__m128i const *)(p + i)));
+		__m128i const b = base64__enc128(_mm_loadu_si128((__m128i const *)(p + i + 12)));
+		_mm256_storeu_si256((__m256i *)cs, _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1));
+	}
+	return i + base64__encode_ssse3(cs, p + i, n - i);
+}
+#endif
+
+static simd_ssse3 size_t
+base64__decode_ssse3(
+	uint8_t    *p,
+	size_t      n,
+	char const *cs,
+	size_t      m
+) {
+	size_t i = 0, k = 0;
+	for(__m128i v; ((i + 16) <= m) && ((k + 16) <= n); i += 16, k += 12) {
+		if(!base64__dec128(_mm_loadu_si128((__m128i const *)(cs + i)), &v)) break;
+		_mm_storeu_si128((__m128i *)(p + k), v);
+	}
+	return i;
+}
+
+static simd_ssse3 size_t
+base64__count_ssse3(
+	char const *cs,
+	size_t      m,
+	size_t     *np
+) {
+	size_t i = 0, n = 0;
+	for(__m128i hi; (i + 16) <= m; i += 16) {
+		n += 16 - popcount(base64__invalid128(_mm_loadu_si128((__m128i const *)(cs + i)), &hi));
+	}
+	*np = n;
+	return i;
+}
+
+static size_t
+base64__encode_simd(
+	char          *cs,
+	uint8_t const *p,
+	size_t         n
+) {
+#if defined(SIMD_AVX2)
+	if(has_avx2()) return base64__encode_avx2(cs, p, n);
+#endif
+	return has_ssse3() ? base64__encode_ssse3(cs, p, n) : 0;
+}
+
+static size_t
+base64__count_simd(
+	char const *cs,
+	size_t      m,
+	size_t     *np
+) {
+	*np = 0;
+	return has_ssse3() ? base64__count_ssse3(cs, m, np) : 0;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+size_t
+base64_encode_update(
+	struct base64_stream *st,
+	char                 *cs,
+	void const           *p,
+	size_t                n
+) {
+	uint8_t const *b  = p;
+	char    *const ct = cs;
+
+	// complete a group carried over
+	for(; (st->b > 0) && (n > 0); n--) {
+		st->u  = (st->u << 8) | *b++;
+		st->b += 8;
+		if(st->b == 24) {
+			for(int s = 18; s >= 0; s -= 6) {
+				*cs++ = base64__chars[(st->u >> s) & 63];
+			}
+			st->u = st->b = 0;
+		}
+	}
+
+	size_t i = 0;
+#ifdef BASE64__SIMD
+	i   = base64__encode_simd(cs, b, n);
+	cs += (i / 3) * 4;
+#endif
+	for(; (i + 3) <= n; i += 3) {
+		uint32_t const u = ((uint32_t)b[i] << 16) | ((uint32_t)b[i + 1] << 8) | b[i + 2];
+		*cs++ = base64__chars[(u >> 18) & 63];
+		*cs++ = base64__chars[(u >> 12) & 63];
+		*cs++ = base64__chars[(u >>  6) & 63];
+		*cs++ = base64__chars[ u        & 63];
+	}
+	for(; i < n; i++) {
+		st->u  = (st->u << 8) | b[i];
+		st->b += 8;
+	}
+
+	return (size_t)(cs - ct);
+}
+
+size_t
+base64_encode_final(
+	struct base64_stream *st,
+	char                 *cs
+) {
+	size_t k = 0;
+	if(st->b > 0) {
+		// pad the bits out to whole chars
+		int const d = (6 - (st->b % 6)) % 6;
+		uint32_t const u = st->u << d;
+		for(int s = st->b + d - 6; s >= 0; s -= 6) {
+			cs[k++] = base64__chars[(u >> s) & 63];
+		}
+	}
+	st->u = st->b = 0;
+	return k;
+}
+
+size_t
+base64_decode_update(
+	struct base64_stream *st,
+	void                 *p,
+	size_t               *np,
+	char const           *cs,
+	size_t                m
+) {
+	uint8_t     *b = p;
+	size_t const n = *np;
+	size_t       i = 0, k = 0;
+
+	if(!base64__ready()) {
+		*np = 0;
+		return 0;
+	}
+
+#ifdef BASE64__SIMD
+	bool const simd = has_ssse3();
+	size_t     skip = 0;
+#endif
+	while(i < m) {
+#ifdef BASE64__SIMD
+		if(simd && (st->b == 0) && (skip == 0)) {
+			size_t const j = base64__decode_ssse3(b + k, n - k, cs + i, m - i);
+			i += j;
+			k += (j / 4) * 3;
+			// past a char that is not base 64, go on a char at a time for a while
+			skip = 16;
+			continue;
+		}
+		skip -= (skip > 0);
+#endif
+		int const c = base64__dechar(cs[i]);
+		if(c >= 0) {
+			if((st->b >= 2) && (k == n)) break;
+			st->u  = (st->u << 6) | (uint32_t)c;
+			st->b += 6;
+			if(st->b >= 8) {
+				st->b -= 8;
+				b[k++] = (uint8_t)(st->u >> st->b);
+				st->u &= base64__mask64(st->b);
+			}
+		}
+		i++;
+	}
+
+	*np = k;
+	return i;
+}
+
+size_t
+base64_count(
+	char const *cs,
+	size_t      m
+) {
+	size_t i = 0, n = 0;
+
+	if(!base64__ready()) {
+		return 0;
+	}
+
+#ifdef BASE64__SIMD
+	i = base64__count_simd(cs, m, &n);
+#endif
+	for(; i < m; i++) {
+		n += (base64__dechar(cs[i]) >= 0);
+	}
+	return n;
+}
+
+//------------------------------------------------------------------------------
+
 int
 base64__encode(
 	size_t      z,
@@ -213,6 +538,12 @@ base64__encode(
 #if !(BASE64__ASCII_MAP || BASE64__UTF8_MAP)
 	if(base64__mapsize || ((r = base64__initialize()) == 0)) {
 #endif
+		if(z == sizeof(char)) {
+			struct base64_stream st = BASE64_STREAM();
+			cs += base64_encode_update(&st, cs, k, n);
+			cs += base64_encode_final(&st, cs);
+			return r;
+		}
 		int  const  zb = z * CHAR_BIT;
 		int         b  = 0, c = 0, d = 0;
 		uint64_t    u  = 0;
@@ -276,6 +607,16 @@ base64__decode(
 #if !(BASE64__ASCII_MAP || BASE64__UTF8_MAP)
 	if(base64__mapsize || ((r = base64__initialize()) == 0)) {
 #endif
+		if((z == sizeof(char)) && !wrap) {
+			struct base64_stream st = BASE64_STREAM();
+			size_t i = n;
+			base64_decode_update(&st, k, &i, cs, strlen(cs));
+			if((i < n) && (st.b > 0)) {
+				((uint8_t *)k)[i++] = (uint8_t)st.u;
+			}
+			memset((uint8_t *)k + i, 0, n - i);
+			return r;
+		}
 		char const *ct = cs;
 		int  const  zb = z * CHAR_BIT;
 		int         b  = zb, c, d;
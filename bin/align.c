@@ -176,7 +176,7 @@ main(
 				out_name   = argv[argi];
 				out_ispipe = (*out_name == '=');
 				out_name  += out_ispipe;
-				out        = out_ispipe ? popen(out_name, "wb") : fopen(out_name, "wb");
+				out        = out_ispipe ? popen(out_name, POPEN_WB) : fopen(out_name, "wb");
 				if(!out) {
 					perror(out_name);
 					fail();
@@ -225,7 +225,7 @@ main(
 			in_name   = argv[argi++];
 			in_ispipe = (*in_name == '=');
 			in_name  += in_ispipe;
-			in        = in_ispipe ? popen(in_name, "rb") : fopen(in_name, "rb");
+			in        = in_ispipe ? popen(in_name, POPEN_RB) : fopen(in_name, "rb");
 			if(!in) {
 				perror(in_name);
 				fail();
@@ -48,49 +48,151 @@ static FILE       *in;
 static char const *in_name   = "";
 static bool        in_ispipe = false;
 
-static inline int
-scan(
-	char const *fmt,
-	...
-) {
-	int r;
-	va_list va;
-	va_start(va, fmt);
-	r = vfscanf(in, fmt, va);
-	va_end(va);
-	return r;
-}
-
 //------------------------------------------------------------------------------
 
-static FILE       *out;
-static char const *out_name   = "";
-static bool        out_ispipe = false;
+static FILE         *out;
+static char const   *out_name   = "";
+static bool          out_ispipe = false;
+static struct fmtbuf outb;
 
 static inline int
 outchar(
 	int c
 ) {
-	return fputc(c, out);
+	return fmtbuf_putc(&outb, c);
 }
 
 static inline int
-print(
-	char const *fmt,
-	...
+outenum(
+	size_t n,
+	int    width
 ) {
-	int r;
-	va_list va;
-	va_start(va, fmt);
-	r = vfprintf(out, fmt, va);
-	va_end(va);
-	return r;
+	fmtbuf_u64dec_padded(&outb, n, width);
+	fmtbuf_putc(&outb, ':');
+	return outchar(' ');
 }
 
 //------------------------------------------------------------------------------
 
 static inline int isccntrl(int c) { return !iscntrl(c); }
 
+//------------------------------------------------------------------------------
+
+static struct hexlayout hl;
+static size_t           column     = 0;
+static int              enum_width = 0;
+static size_t           col        = 0;
+static size_t           count      = 0;
+static uint8_t          line[16];
+
+static inline void
+outbyte(
+	uint8_t u
+) {
+	hexencode(fmtbuf_reserve(&outb, 2), &u, 1, 1, true);
+	fmtbuf_advance(&outb, 2);
+}
+
+static void
+outvalues(
+	uint8_t const *b,
+	size_t         n
+) {
+	size_t const w = hexlayout_width(&hl);
+	size_t const l = (FMTBUF_SIZE - 1) / w;
+	while(n > 0) {
+		size_t k = (n < l) ? n : l;
+		if((column > 0) && ((column - col) < k)) {
+			k = column - col;
+		}
+		char  *cs = fmtbuf_reserve(&outb, (k * w) + 1);
+		size_t m  = hexlayout_encode(&hl, cs, b, k);
+		b     += k * hl.z;
+		n     -= k;
+		col   += k;
+		count += k;
+		if(col == column) {
+			if(hl.spaced) cs[m - 1] = '\n';
+			else          cs[m++]   = '\n';
+			fmtbuf_advance(&outb, m);
+			col = 0;
+			if(enum_width) outenum(count, enum_width);
+			continue;
+		}
+		fmtbuf_advance(&outb, m);
+	}
+}
+
+static void
+outsideview(
+	uint8_t const *b,
+	size_t         n,
+	int          (*printable)(int)
+) {
+	while(n > 0) {
+		size_t const k = (n < (column - col)) ? n : (column - col);
+		memcpy(line + col, b, k);
+		fmtbuf_advance(&outb, hexlayout_encode(&hl, fmtbuf_reserve(&outb, k * 3), b, k));
+		b     += k;
+		n     -= k;
+		col   += k;
+		count += k;
+		if(col == column) {
+			outchar('|');
+			for(size_t j = 0; j < col; j++) {
+				outchar(printable(line[j]) ? line[j] : '.');
+			}
+			outchar('|');
+			outchar('\n');
+			col = 0;
+			if(enum_width) outenum(count, enum_width);
+		}
+	}
+}
+
+static void
+endsideview(
+	void
+) {
+	fmtbuf_pad(&outb, ' ', (column - col) * 3);
+	outchar('|');
+	for(size_t j = 0; j < col; j++) {
+		outchar(isprint(line[j]) ? line[j] : '.');
+	}
+	fmtbuf_pad(&outb, ' ', column - col);
+	outchar('|');
+	outchar('\n');
+}
+
+static bool
+unhex(
+	void  *buffer,
+	size_t n_values,
+	char  *text,
+	size_t text_size
+) {
+	size_t m   = 0;
+	bool   end = false;
+	while(!gSignal) {
+		if(!end) {
+			size_t const r = fread(text + m, 1, text_size - m, in);
+			m  += r;
+			end = (r == 0) || feof(in) || ferror(in);
+		}
+
+		size_t n  = n_values;
+		size_t mp = m;
+		int const rc = hexlayout_decode(&hl, buffer, &n, text, &mp, end);
+		if((n > 0) && (fwrite(buffer, hl.z, n, out) != n)) {
+			return false;
+		}
+		memmove(text, text + mp, m - mp);
+		m -= mp;
+		if((rc < 0) || ((rc == 0) && end)) break;
+	}
+	return true;
+}
+
 //------------------------------------------------------------------------------
 #ifndef NDEBUG
 int
@@ -146,8 +248,6 @@ main(
 	bool   side_view           = false;
 	bool   extended_side_view  = false;
 	bool   calculate_column    = false;
-	int    enum_width          = 0;
-	size_t column              = 0;
 	size_t bufsize             = BUFSIZE;
 	bool   ignore_interrupts   = false;
 
@@ -169,7 +269,7 @@ main(
 				out_name   = argv[argi];
 				out_ispipe = (*out_name == '=');
 				out_name  += out_ispipe;
-				out        = out_ispipe ? popen(out_name, "wb") : fopen(out_name, "wb");
+				out        = out_ispipe ? popen(out_name, POPEN_WB) : fopen(out_name, "wb");
 				if(!out) {
 					perror(out_name);
 					fail();
@@ -293,7 +393,7 @@ main(
 			;
 	}
 
-	size_t  const bits   = (line_view || alternate_line_view || side_view) ? (
+	size_t const bits = (line_view || alternate_line_view || side_view) ? (
 		8
 	):(
 		((argi < argc) && str_is(argv[argi], isdigit)) ? (
@@ -302,41 +402,30 @@ main(
 			64
 		)
 	);
-	size_t  const bytes  = bits / 8;
-	size_t  const COUNT  = bufsize / bytes;
-	void   *const buffer = malloc(bufsize = COUNT * bytes);
+	if((bits != 8) && (bits != 16) && (bits != 32) && (bits != 64)) {
+		errorf("invalid BITS: %zu", bits);
+		fail();
+	}
+	size_t const bytes = bits / 8;
+	size_t const COUNT = bufsize / bytes;
+	void  *const buffer = malloc(bufsize = COUNT * bytes);
 	if(!buffer) {
 		perror();
 		fail();
 	}
-	char *format;
-	{
-		int n_digits   = bits / 4;
-		int prefix_len = strlen(prefix);
-		int suffix_len = strlen(suffix);
-		format = malloc(prefix_len + suffix_len + 16);
-		if(!format) {
-			perror();
-			fail();
-		}
-		char const *fmt;
-		if(ashex) {
-			switch(bits) {
-			case  8: fmt = PRIX8 ; break;
-			case 16: fmt = PRIX16; break;
-			case 32: fmt = PRIX32; break;
-			default: fmt = PRIX64; break;
-			}
-			sprintf(format, "%s%%%i.%i%s%s", prefix, n_digits, n_digits, fmt, suffix);
-		} else {
-			switch(bits) {
-			case  8: fmt = SCNx8 ; break;
-			case 16: fmt = SCNx16; break;
-			case 32: fmt = SCNx32; break;
-			default: fmt = SCNx64; break;
-			}
-			sprintf(format, " %s%%%i%s%s", prefix, n_digits, fmt, suffix);
-		}
+	hexlayout_init(&hl, bytes, true, prefix, suffix, spaced);
+	if(hexlayout_width(&hl) > (FMTBUF_SIZE / 4)) {
+		errorf("prefix and suffix too long");
+		fail();
+	}
+	size_t const text_size = (bufsize * 2) + (hexlayout_width(&hl) * 4);
+	char  *const text      = ashex ? NULL : malloc(text_size);
+	if(!ashex && !text) {
+		perror();
+		fail();
+	}
+	if(calculate_column) {
+		column = (bytes > 2) ? 4 : 8;
 	}
 	if(ignore_interrupts) {
 		signal(SIGINT, SIG_IGN);
@@ -347,7 +436,7 @@ main(
 	_setmode(_fileno(stdin), _O_BINARY);
 	_setmode(_fileno(stdout), _O_BINARY);
 #endif
-	size_t col = 0, count = 0;
+	fmtbuf_init(&outb, out);
 	do {
 		if(argi < argc) {
 			if(in != stdin) {
@@ -356,254 +445,98 @@ main(
 			in_name   = argv[argi++];
 			in_ispipe = (*in_name == '=');
 			in_name  += in_ispipe;
-			in        = in_ispipe ? popen(in_name, "rb") : fopen(in_name, "rb");
+			in        = in_ispipe ? popen(in_name, POPEN_RB) : fopen(in_name, "rb");
 			if(!in) {
+				fmtbuf_flush(&outb);
 				perror(in_name);
 				fail();
 			}
 		}
-		if(ashex) switch(bits) {
-		case 8:
-			if(calculate_column) column = 8;
-			if(enum_width) print("%.*zu: ", enum_width, count);
-			if(side_view) {
-				int (*printable)(int) = extended_side_view ? isccntrl : isprint;
-				for(uint8_t *b = buffer; !gSignal;) {
-					size_t n = fread(b, sizeof(*b), COUNT, in);
-					size_t i = 0;
-					for(; !gSignal && (i < n);) {
-						print(format, b[i++]);
-						count++;
-						if(++col == column) {
-							outchar(' ');
-							outchar('|');
-							for(size_t j = i - col; j < i; j++) {
-								if(printable(b[j])) outchar(b[j]);
-								else                outchar('.');
-							}
-							outchar('|');
-							outchar('\n');
-							col = 0;
-							if(enum_width) print("%.*zu: ", enum_width, count);
-							continue;
-						}
-						outchar(' ');
-					}
-					if(n < COUNT) {
-						if(col > 0) {
-							for(size_t j = column - col; j-- > 0;) {
-								outchar(' ');
-								outchar(' ');
-								outchar(' ');
-							}
-							outchar('|');
-							for(size_t j = i - col; j < i; j++) {
-								if(isprint(b[j])) outchar(b[j]);
-								else              outchar('.');
-							}
-							for(size_t j = column - col; j-- > 0;) {
-								outchar(' ');
-							}
-							outchar('|');
-							outchar('\n');
-							col = count = 0;
-						}
-						break;
-					}
-				}
-			} else if(line_view) {
-				for(uint8_t *b = buffer; !gSignal;) {
-					size_t n = fread(b, sizeof(*b), COUNT, in);
-					size_t i = 0;
-					for(; !gSignal && (i < n);) {
-						bool lf = b[i] == eol;
-						print(format, b[i++]);
-						count++;
-						if(lf) {
-							outchar('\n');
-							col = 0;
-							if(enum_width) print("%.*zu: ", enum_width, count);
-						} else {
-							outchar(' ');
-							col++;
-						}
-					}
-					if(n < COUNT) {
-						if(col > 0) {
-							outchar('\n');
-							col = count = 0;
-						}
-						break;
-					}
-				}
-			} else if(alternate_line_view) {
-				for(uint8_t *b = buffer; !gSignal;) {
-					size_t n = fread(b, sizeof(*b), COUNT, in);
-					size_t i = 0;
-					for(; !gSignal && (i < n);) {
-						bool lf = b[i] == eol;
-						if(lf) {
-							if(count > 0) {
-								outchar('\n');
-								col = 0;
-								if(enum_width) print("%.*zu: ", enum_width, count);
-							}
-						} else if(col > 0) {
-							outchar(' ');
-						}
-						print(format, b[i++]);
-						count++;
-						col++;
-					}
-					if(n < COUNT) {
-						if(col > 0) {
-							outchar('\n');
-							col = count = 0;
-						}
-						break;
-					}
-				}
-			} else {
-				for(uint8_t *b = buffer; !gSignal;) {
-					size_t n = fread(b, sizeof(*b), COUNT, in);
-					size_t i = 0;
-					for(; !gSignal && (i < n);) {
-						print(format, b[i++]);
-						count++;
-						if(++col == column) {
-							outchar('\n');
-							col = 0;
-							if(enum_width) print("%.*zu: ", enum_width, count);
-							continue;
-						}
-						if(spaced) outchar(' ');
-					}
-					if(n < COUNT) {
-						if(col > 0) {
-							if(enum_width) {
-								outchar('\n');
-								col = count = 0;
-							}
-						}
-						break;
-					}
-				}
+		if(!ashex) {
+			if(!unhex(buffer, COUNT, text, text_size)) {
+				perror(out_name);
+				fail();
 			}
-			break;
-		case 16:
-			if(calculate_column) column = 8;
-			if(enum_width) print("%.*zu: ", enum_width, count);
-			for(uint16_t *b = buffer; !gSignal;) {
+			continue;
+		}
+		if(enum_width) outenum(count, enum_width);
+		if(side_view) {
+			int (*printable)(int) = extended_side_view ? isccntrl : isprint;
+			for(uint8_t *b = buffer; !gSignal;) {
 				size_t n = fread(b, sizeof(*b), COUNT, in);
-				for(size_t i = 0; !gSignal && (i < n); i++) {
-					print(format, b[i]);
-					count++;
-					if(++col == column) {
-						outchar('\n');
-						col = 0;
-						if(enum_width) print("%.*zu: ", enum_width, count);
-						continue;
-					}
-					if(spaced) outchar(' ');
-				}
+				outsideview(b, n, printable);
 				if(n < COUNT) {
-					if(enum_width) {
-						outchar('\n');
+					if(col > 0) {
+						endsideview();
 						col = count = 0;
 					}
 					break;
 				}
 			}
-			break;
-		case 32:
-			if(calculate_column) column = 4;
-			if(enum_width) print("%.*zu: ", enum_width, count);
-			for(uint32_t *b = buffer; !gSignal;) {
+		} else if(line_view) {
+			for(uint8_t *b = buffer; !gSignal;) {
 				size_t n = fread(b, sizeof(*b), COUNT, in);
-				for(size_t i = 0; !gSignal && (i < n); i++) {
-					print(format, b[i]);
+				size_t i = 0;
+				for(; !gSignal && (i < n);) {
+					bool lf = b[i] == eol;
+					outbyte(b[i++]);
 					count++;
-					if(++col == column) {
+					if(lf) {
 						outchar('\n');
 						col = 0;
-						if(enum_width) print("%.*zu: ", enum_width, count);
-						continue;
+						if(enum_width) outenum(count, enum_width);
+					} else {
+						outchar(' ');
+						col++;
 					}
-					if(spaced) outchar(' ');
 				}
 				if(n < COUNT) {
-					if(enum_width) {
+					if(col > 0) {
 						outchar('\n');
 						col = count = 0;
 					}
 					break;
 				}
 			}
-			break;
-		case 64:
-			if(calculate_column) column = 4;
-			if(enum_width) print("%.*zu: ", enum_width, count);
-			for(uint64_t *b = buffer; !gSignal;) {
+		} else if(alternate_line_view) {
+			for(uint8_t *b = buffer; !gSignal;) {
 				size_t n = fread(b, sizeof(*b), COUNT, in);
-				for(size_t i = 0; !gSignal && (i < n); i++) {
-					print(format, b[i]);
-					count++;
-					if(++col == column) {
-						outchar('\n');
-						col = 0;
-						if(enum_width) print("%.*zu: ", enum_width, count);
-						continue;
+				size_t i = 0;
+				for(; !gSignal && (i < n);) {
+					bool lf = b[i] == eol;
+					if(lf) {
+						if(count > 0) {
+							outchar('\n');
+							col = 0;
+							if(enum_width) outenum(count, enum_width);
+						}
+					} else if(col > 0) {
+						outchar(' ');
 					}
-					if(spaced) outchar(' ');
+					outbyte(b[i++]);
+					count++;
+					col++;
 				}
 				if(n < COUNT) {
-					if(enum_width) {
+					if(col > 0) {
 						outchar('\n');
 						col = count = 0;
 					}
 					break;
 				}
 			}
-			break;
-		} else switch(bits) {
-		case 8:
+		} else {
 			for(uint8_t *b = buffer; !gSignal;) {
-				size_t n = 0;
-				for(; !gSignal && (n < COUNT); n++) {
-					if(scan(format, &b[n]) != 1) break;
-				}
-				if((n > 0) && (fwrite(b, sizeof(*b), n, out) != n)) break;
-				if(n < COUNT) break;
-			}
-			break;
-		case 16:
-			for(uint16_t *b = buffer; !gSignal;) {
-				size_t n = 0;
-				for(; !gSignal && (n < COUNT); n++) {
-					if(scan(format, &b[n]) != 1) break;
-				}
-				if((n > 0) && (fwrite(b, sizeof(*b), n, out) != n)) break;
-				if(n < COUNT) break;
-			}
-			break;
-		case 32:
-			for(uint32_t *b = buffer; !gSignal;) {
-				size_t n = 0;
-				for(; !gSignal && (n < COUNT); n++) {
-					if(scan(format, b[n]) != 1) break;
-				}
-				if((n > 0) && (fwrite(b, sizeof(*b), n, out) != n)) break;
-				if(n < COUNT) break;
-			}
-			break;
-		case 64:
-			for(uint64_t *b = buffer; !gSignal;) {
-				size_t n = 0;
-				for(; !gSignal && (n < COUNT); n++) {
-					if(scan(format, &b[n]) != 1) break;
+				size_t n = fread(b, bytes, COUNT, in);
+				outvalues(b, n);
+				if(n < COUNT) {
+					// bytes are only ended, by an enumeration, part way through a line
+					if(enum_width && ((col > 0) || (bytes > 1))) {
+						outchar('\n');
+						col = count = 0;
+					}
+					break;
 				}
-				if((n > 0) && (fwrite(b, sizeof(*b), n, out) != n)) break;
-				if(n < COUNT) break;
 			}
 		}
 	} while(!gSignal && (argi < argc))
@@ -611,5 +544,9 @@ main(
 	if(col > 0) {
 		outchar('\n');
 	}
+	if(fmtbuf_flush(&outb) != 0) {
+		perror(out_name);
+		fail();
+	}
 	return 0;
 }
@@ -25,20 +25,279 @@ SOFTWARE.
 //------------------------------------------------------------------------------
 
 #include <hol/holibc.h>
+#include <pthread.h>
+
+//------------------------------------------------------------------------------
+
+static FILE       *in;
+static char const *in_name    = "";
+static bool        in_ispipe  = false;
+
+static FILE       *out;
+static char const *out_name   = "";
+static bool        out_ispipe = false;
+
+//------------------------------------------------------------------------------
+
+#define BLOCK_SIZE  (1 Mi)
+
+static uint8_t inbuf [BLOCK_SIZE];
+static uint8_t outbuf[BLOCK_SIZE + BLOCK_SIZE / 2];
+
+static bool
+outblock(
+	void const *p,
+	size_t      n
+) {
+	if(fwrite(p, 1, n, out) != n) {
+		perror(out_name);
+		return false;
+	}
+	return true;
+}
+
+static bool
+transcode(
+	bool decode
+) {
+	struct base64_stream st = BASE64_STREAM();
+	for(size_t n; (n = fread(inbuf, 1, BLOCK_SIZE, in)) > 0; ) {
+		if(decode) {
+			for(size_t i = 0; i < n; ) {
+				size_t k = sizeof(outbuf);
+				i += base64_decode_update(&st, outbuf, &k, (char const *)inbuf + i, n - i);
+				if(!outblock(outbuf, k)) return false;
+			}
+		} else {
+			size_t const k = base64_encode_update(&st, (char *)outbuf, inbuf, n);
+			if(!outblock(outbuf, k)) return false;
+		}
+	}
+	if(ferror(in)) {
+		perror(in_name);
+		return false;
+	}
+	if(!decode) {
+		size_t const k = base64_encode_final(&st, (char *)outbuf);
+		outbuf[k] = '\n';
+		if(!outblock(outbuf, k + 1)) return false;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+
+#define MAX_THREADS  (256)
+#define CHUNK_SIZE   (768 Ki)
+
+// -j reads the input a round of one chunk per thread at a time; each chunk is
+// transcoded into its own buffer, and the buffers are written out in order
+
+struct chunk {
+	pthread_t   thread;
+	bool        threaded;
+	char const *src;
+	size_t      n;
+	char       *dst;
+	size_t      z;
+};
+
+static void *
+encode_chunk(
+	void *arg
+) {
+	struct chunk        *c  = arg;
+	struct base64_stream st = BASE64_STREAM();
+	size_t k = base64_encode_update(&st, c->dst, c->src, c->n);
+	k += base64_encode_final(&st, c->dst + k);
+	c->z = k;
+	return NULL;
+}
+
+static void *
+decode_chunk(
+	void *arg
+) {
+	struct chunk        *c  = arg;
+	struct base64_stream st = BASE64_STREAM();
+	base64_decode_update(&st, c->dst, &c->z, c->src, c->n);
+	return NULL;
+}
+
+static void *
+count_chunk(
+	void *arg
+) {
+	struct chunk *c = arg;
+	c->z = base64_count(c->src, c->n);
+	return NULL;
+}
+
+static void
+run_chunks(
+	struct chunk *c,
+	size_t        n,
+	void       *(*fn)(void *)
+) {
+	// any chunk a thread can not be started for is done here
+	for(size_t i = 0; i < n; i++) {
+		c[i].threaded = (i > 0) && (pthread_create(&c[i].thread, NULL, fn, &c[i]) == 0);
+	}
+	for(size_t i = 0; i < n; i++) {
+		if(c[i].threaded) {
+			pthread_join(c[i].thread, NULL);
+		} else {
+			fn(&c[i]);
+		}
+	}
+}
+
+static size_t
+skip_chars(
+	char const *cs,
+	size_t      m,
+	size_t      r
+) {
+	size_t i = 0;
+	for(; (r > 0) && (i < m); i++) {
+		r -= (base64__dechar(cs[i]) >= 0);
+	}
+	return i;
+}
+
+static size_t
+split_decode(
+	struct chunk *c,
+	size_t        n_threads,
+	char const   *p,
+	size_t        n,
+	bool          end
+) {
+	// the round is split on 4 char groups, less any chars that are not base 64,
+	// which are counted a chunk at a time to find the offsets; short of the end,
+	// the chars of a trailing partial group are held over to the next round
+	size_t const per = (n + n_threads - 1) / n_threads;
+	for(size_t i = 0; i < n_threads; i++) {
+		size_t const o = ((i * per) < n) ? (i * per) : n;
+		c[i].src = p + o;
+		c[i].n   = ((n - o) < per) ? (n - o) : per;
+	}
+	run_chunks(c, n_threads, count_chunk);
+	size_t t[MAX_THREADS + 1];
+	size_t v = 0;
+	for(size_t i = 0; i < n_threads; i++) {
+		size_t const r = (4 - (v % 4)) % 4;
+		size_t const o = (size_t)(c[i].src - p);
+		t[i] = v + r;
+		v   += c[i].z;
+		c[i].src += skip_chars(c[i].src, n - o, r);
+	}
+	char const *e = p + n;
+	if(!end) {
+		for(size_t r = v % 4; r > 0; r -= (base64__dechar(*e) >= 0)) {
+			e--;
+		}
+		v -= v % 4;
+	}
+	t[n_threads] = v;
+	for(size_t i = 0; i < n_threads; i++) {
+		if(t[i] > v) t[i] = v;
+	}
+	for(size_t i = 0; i < n_threads; i++) {
+		char const *ei = (i == (n_threads - 1)) ? e : c[i + 1].src;
+		if(ei > e) ei = e;
+		c[i].n = (c[i].src < ei) ? (size_t)(ei - c[i].src) : 0;
+		c[i].z = ((t[i + 1] * 3) / 4) - ((t[i] * 3) / 4);
+	}
+	return (size_t)(e - p);
+}
+
+static size_t
+split_encode(
+	struct chunk *c,
+	size_t        n_threads,
+	char const   *p,
+	size_t        n
+) {
+	// the round is split on multiples of 3 bytes, which encode independently
+	size_t const per = (((n + n_threads - 1) / n_threads) + 2) / 3 * 3;
+	for(size_t i = 0; i < n_threads; i++) {
+		size_t const o = ((i * per) < n) ? (i * per) : n;
+		c[i].src = p + o;
+		c[i].n   = ((n - o) < per) ? (n - o) : per;
+	}
+	return n;
+}
+
+static bool
+transcode_chunked(
+	bool   decode,
+	size_t n_threads
+) {
+	struct chunk c[MAX_THREADS] = { 0 };
+	size_t const z = n_threads * CHUNK_SIZE;
+	char  *const b = malloc(z);
+	bool         ok = (b != NULL);
+	for(size_t i = 0; ok && (i < n_threads); i++) {
+		c[i].dst = malloc(base64enclen(CHUNK_SIZE + 2));
+		ok = (c[i].dst != NULL);
+	}
+	if(!ok) {
+		perror();
+		goto error_return;
+	}
+
+	for(size_t h = 0, n; ok && ((n = h + fread(b + h, 1, z - h, in)) > 0); ) {
+		bool const end = (n < z);
+		if(end && ferror(in)) {
+			perror(in_name);
+			ok = false;
+			break;
+		}
+		size_t const k = decode ? split_decode(c, n_threads, b, n, end) : split_encode(c, n_threads, b, n);
+		run_chunks(c, n_threads, decode ? decode_chunk : encode_chunk);
+		for(size_t i = 0; ok && (i < n_threads); i++) {
+			ok = outblock(c[i].dst, c[i].z);
+		}
+		if(end) break;
+		h = 0;
+		for(size_t i = k; i < n; i++) {
+			if(base64__dechar(b[i]) >= 0) b[h++] = b[i];
+		}
+	}
+	if(ok && !decode) {
+		ok = outblock("\n", 1);
+	}
+
+error_return:
+	for(size_t i = 0; i < n_threads; i++) {
+		free(c[i].dst);
+	}
+	free(b);
+	return ok;
+}
 
 //------------------------------------------------------------------------------
 
 int main(int argc, char **argv) {
 	static struct optget options[] = {
-		{  0, "usage: %s [OPTION]... [TEXT]...",   NULL },
+		{  0, "usage: %s [OPTION]... [TEXT|FILE]...",   NULL },
 		{  0, "options:",                NULL },
 		{  1, "-h, --help",              "display help" },
+		{  2, "-o, --output FILE",       "output to FILE" },
+		{  3, "-f, --files",             "transcode FILEs, or stdin if none, rather than TEXT" },
+		{  4, "-j, --jobs N",            "transcode FILEs, or stdin, with N threads" },
 		{ 10, "-d, --decode",            "decode TEXT from base 64" },
 		{ 11, "-e, --encode",            "encode TEXT to base 64" },
 	};
 	static size_t const n_options = (sizeof(options) / sizeof(options[0]));
 
+	in  = stdin;
+	out = stdout;
+
 	bool decode = true;
+	bool files  = false;
+	size_t n_threads = 1;
 
 	int argi = 1;
 	while((argi < argc) && (*argv[argi] == '-')) {
@@ -51,6 +310,30 @@ int main(int argc, char **argv) {
 			case 1:
 				optuse(n_options, options, argv[0], stdout);
 				return 0;
+			case 2:
+				if(out != stdout) {
+					out_ispipe ? pclose(out) : fclose(out);
+				}
+				out_name   = argv[argi];
+				out_ispipe = (*out_name == '=');
+				out_name  += out_ispipe;
+				out        = out_ispipe ? popen(out_name, POPEN_WB) : fopen(out_name, "wb");
+				if(!out) {
+					perror(out_name);
+					fail();
+				}
+				break;
+			case 3:
+				files = true;
+				break;
+			case 4:
+				n_threads = streval(argv[argi], NULL, 0);
+				if((n_threads == 0) || (n_threads > MAX_THREADS)) {
+					errorf("invalid thread count: %s", argv[argi]);
+					fail();
+				}
+				files = true;
+				break;
 			case 10:
 				decode = true;
 				break;
@@ -67,6 +350,37 @@ int main(int argc, char **argv) {
 			;
 	}
 
+	if(files) {
+#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+		_setmode(_fileno(out), _O_BINARY);
+#endif
+		do {
+			if(argi < argc) {
+				if(in != stdin) {
+					in_ispipe ? pclose(in) : fclose(in);
+				}
+				in_name   = argv[argi++];
+				in_ispipe = (*in_name == '=');
+				in_name  += in_ispipe;
+				in        = in_ispipe ? popen(in_name, POPEN_RB) : fopen(in_name, "rb");
+				if(!in) {
+					perror(in_name);
+					fail();
+				}
+			}
+			if(!((n_threads > 1) ? transcode_chunked(decode, n_threads) : transcode(decode))) {
+				fail();
+			}
+		} while(argi < argc)
+			;
+		if(fflush(out) != 0) {
+			perror(out_name);
+			fail();
+		}
+		return 0;
+	}
+
 	while(argi < argc) {
 		char const *args = argv[argi++];
 		size_t n = strlen(args);
@@ -81,7 +395,8 @@ int main(int argc, char **argv) {
 		} else {
 			base64encode(n, args, s);
 		}
-		puts(s);
+		fputs(s, out);
+		fputc('\n', out);
 		free(s);
 	}
 
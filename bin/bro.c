@@ -48,12 +48,16 @@ static FILE       *in;
 static char const *in_name   = "";
 static bool        in_ispipe = false;
 
+static void (*ldwords)(void const *p, void *q, size_t n) = NULL;
+
 static inline size_t
 ingest(
 	uint64_t *w,
 	size_t    n
 ) {
-	return fread(w, sizeof(*w), n, in);
+	n = fread(w, sizeof(*w), n, in);
+	if(ldwords) ldwords(w, w, n);
+	return n;
 }
 
 //------------------------------------------------------------------------------
@@ -62,16 +66,138 @@ static FILE       *out;
 static char const *out_name   = "";
 static bool        out_ispipe = false;
 
+static void (*stwords)(void const *q, void *p, size_t n) = NULL;
+
 static inline size_t
 egest(
-	uint64_t const *w,
-	size_t          n
+	uint64_t *w,
+	size_t    n
 ) {
+	if(stwords) stwords(w, w, n);
 	return fwrite(w, sizeof(*w), n, out);
 }
 
 //------------------------------------------------------------------------------
 
+static void
+setbyteorder(
+	char const *arg
+) {
+	if(streq(arg, "le") || streq(arg, "LE")) {
+		ldwords = ldu64le_array;
+		stwords = stu64le_array;
+		return;
+	}
+	if(streq(arg, "be") || streq(arg, "BE")) {
+		ldwords = ldu64be_array;
+		stwords = stu64be_array;
+		return;
+	}
+	if(streq(arg, "native")) {
+		ldwords = NULL;
+		stwords = NULL;
+		return;
+	}
+
+	errorf("unknown byte order %s", arg);
+	fail();
+}
+
+//------------------------------------------------------------------------------
+
+// the bit mapping is fixed for the whole run, so it is compiled once into a
+// plan: either a few rotate and mask groups, or byte lookup tables when the
+// mapping scatters bits over too many distinct rotations
+
+#define PLAN_MAX_ROTATIONS  8
+
+struct plan {
+	void   (*apply)(struct plan const *pp, uint64_t *w, size_t n);
+	uint64_t keep;
+	size_t   n_rotations;
+	int      rotation[64];
+	uint64_t mask[64];
+	uint64_t table[8][256];
+};
+
+static void
+plan_rotate(
+	struct plan const *pp,
+	uint64_t          *w,
+	size_t             n
+) {
+	for(size_t i = 0; i < n; i++) {
+		uint64_t const u = w[i];
+		uint64_t       v = u & pp->keep;
+		for(size_t j = 0; j < pp->n_rotations; j++) {
+			v |= rotl(u & pp->mask[j], pp->rotation[j]);
+		}
+		w[i] = v;
+	}
+}
+
+static void
+plan_lookup(
+	struct plan const *pp,
+	uint64_t          *w,
+	size_t             n
+) {
+	for(size_t i = 0; i < n; i++) {
+		uint64_t const u = w[i];
+		w[i] = pp->table[0][(u >>  0) & 0xFF]
+		|      pp->table[1][(u >>  8) & 0xFF]
+		|      pp->table[2][(u >> 16) & 0xFF]
+		|      pp->table[3][(u >> 24) & 0xFF]
+		|      pp->table[4][(u >> 32) & 0xFF]
+		|      pp->table[5][(u >> 40) & 0xFF]
+		|      pp->table[6][(u >> 48) & 0xFF]
+		|      pp->table[7][(u >> 56) & 0xFF]
+		;
+	}
+}
+
+static void
+plan_compile(
+	struct plan *pp,
+	size_t       start1,
+	size_t       step1,
+	size_t       start2,
+	size_t       step2
+) {
+	uint64_t rotated[64] = { 0 };
+	uint64_t target[64]  = { 0 };
+	for(size_t j = 0, k1 = start1, k2 = start2; j < 64; j++) {
+		rotated[(k2 - k1) & 63] |= UINT64_C(1) << k1;
+		target[k1]              |= UINT64_C(1) << k2;
+		k1 = incwrap(k1, step1, 63);
+		k2 = incwrap(k2, step2, 63);
+	}
+
+	pp->keep        = rotated[0];
+	pp->n_rotations = 0;
+	for(int r = 1; r < 64; r++) {
+		if(rotated[r]) {
+			pp->rotation[pp->n_rotations] = r;
+			pp->mask[pp->n_rotations]     = rotated[r];
+			pp->n_rotations++;
+		}
+	}
+	if(pp->n_rotations <= PLAN_MAX_ROTATIONS) {
+		pp->apply = plan_rotate;
+		return;
+	}
+
+	for(size_t b = 0; b < 8; b++) {
+		pp->table[b][0] = 0;
+		for(size_t x = 1; x < 256; x++) {
+			pp->table[b][x] = pp->table[b][x & (x - 1)] | target[(b * 8) + tzcount(x)];
+		}
+	}
+	pp->apply = plan_lookup;
+}
+
+//------------------------------------------------------------------------------
+
 #ifndef NDEBUG
 int
 main(
@@ -97,6 +223,7 @@ main(
 		{  1, "-h, --help",              "display help" },
 		{  2, "-o, --output FILE",       "output to FILE" },
 		{  3, "-b, --buffer SIZE",       "set buffer SIZE" },
+		{  4, "--byte-order ORDER",      "words are in ORDER: le, be or native (default)" },
 		{ 99, "-I, --ignore-interrupts", "ignore interrupt signals" },
 	};
 	static size_t const n_options = (sizeof(options) / sizeof(options[0]));
@@ -125,7 +252,7 @@ main(
 				out_name   = argv[argi];
 				out_ispipe = (*out_name == '=');
 				out_name  += out_ispipe;
-				out        = out_ispipe ? popen(out_name, "wb") : fopen(out_name, "wb");
+				out        = out_ispipe ? popen(out_name, POPEN_WB) : fopen(out_name, "wb");
 				if(!out) {
 					perror(out_name);
 					fail();
@@ -135,6 +262,9 @@ main(
 				bufsize = streval(argv[argi], NULL, 0);
 				if(!bufsize) bufsize = BUFSIZE;
 				break;
+			case 4:
+				setbyteorder(argv[argi]);
+				break;
 			case 99:
 				ignore_interrupts = true;
 				break;
@@ -170,6 +300,9 @@ main(
 		fail();
 	}
 
+	static struct plan plan;
+	plan_compile(&plan, start1, step1, start2, step2);
+
 	if(ignore_interrupts) {
 		signal(SIGINT, SIG_IGN);
 	} else {
@@ -187,27 +320,14 @@ main(
 			in_name   = argv[argi++];
 			in_ispipe = (*in_name == '=');
 			in_name  += in_ispipe;
-			in        = in_ispipe ? popen(in_name, "rb") : fopen(in_name, "rb");
+			in        = in_ispipe ? popen(in_name, POPEN_RB) : fopen(in_name, "rb");
 			if(!in) {
 				perror(in_name);
 				fail();
 			}
 		}
 		for(size_t n; !gSignal && ((n = ingest(buffer, buflen)) > 0);) {
-			for(size_t i = 0; !gSignal && (i < n); i++) {
-				uint64_t u  = buffer[i];
-				uint64_t v  = 0;
-				for(size_t j = 0, k1 = start1, k2 = start2; j < 64; j++) {
-					uint64_t m1 = UINT64_C(1) << k1;
-					uint64_t m2 = UINT64_C(1) << k2;
-					k1 = incwrap(k1, step1, 63);
-					k2 = incwrap(k2, step2, 63);
-					if(u & m1) {
-						v |= m2;
-					}
-				}
-				buffer[i] = v;
-			}
+			plan.apply(&plan, buffer, n);
 			if(gSignal) break;
 			if(!egest(buffer, n)) {
 				perror(out_name);
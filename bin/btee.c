@@ -24,13 +24,25 @@ SOFTWARE.
 
 //------------------------------------------------------------------------------
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
 #include <hol/holibc.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdio.h>
+#include <sys/stat.h>
 #ifdef _WIN32
 #include <fcntl.h>
 #include <io.h>
 #endif
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef SPLICE_F_MOVE
+#define BTEE_SPLICE  (1)
+#endif
+#endif
 
 //------------------------------------------------------------------------------
 
@@ -45,12 +57,475 @@ signal_handler(
 
 //------------------------------------------------------------------------------
 
+// what to do with an output that has fallen a whole queue behind; a regular
+// file is never more than briefly behind, so is always waited for
+enum {
+	POLICY_BLOCK,
+	POLICY_DROP,
+	POLICY_CLOSE,
+};
+
+static int    policy           = POLICY_BLOCK;
+static size_t queue_depth      = 16;
+static bool   error_messages   = true;
+static bool   close_on_error   = false;
+static bool   halt_first_error = false;
+
+struct btee_block {
+	struct btee_block *next;
+	size_t             refs;
+	size_t             n;
+	uint8_t            data[];
+};
+
 struct btee_file {
-	FILE       *stream;
-	bool        is_pipe;
-	char const *name;
+	FILE               *stream;
+	bool                is_pipe;
+	char const         *name;
+	bool                regular;
+	bool                threaded;
+	bool                closed;
+	pthread_t           thread;
+	size_t              head;
+	size_t              tail;
+	struct btee_block **queue;
+#ifdef BTEE_SPLICE
+	int                 fd;
+	int                 pipe[2];
+	size_t              sent;
+#endif
 };
 
+static int
+setpolicy(
+	char const *arg
+) {
+	if(streq(arg, "block")) return POLICY_BLOCK;
+	if(streq(arg, "drop"))  return POLICY_DROP;
+	if(streq(arg, "close")) return POLICY_CLOSE;
+	return -1;
+}
+
+static void
+close_output(
+	struct btee_file *fp
+) {
+	if(fp->is_pipe) {
+		pclose(fp->stream);
+	} else if(fp->stream != stdout) {
+		fclose(fp->stream);
+	}
+	fp->stream = NULL;
+}
+
+// reports an output error, and returns -1 to halt, 1 to close the output, or
+// 0 to carry on with it
+static int
+output_error(
+	struct btee_file *fp
+) {
+	if(error_messages) perror(fp->name);
+	if(halt_first_error) return -1;
+	return close_on_error;
+}
+
+//------------------------------------------------------------------------------
+
+// writer threads: every output has a thread and a bounded queue of blocks; a
+// block is shared by all the queues it is on, and goes back on the free list
+// once the last of them has written it
+
+static pthread_mutex_t    lock        = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t     cond        = PTHREAD_COND_INITIALIZER;
+static struct btee_block *free_blocks = NULL;
+static bool               finished    = false;
+static bool               halted      = false;
+
+static struct btee_block *
+get_block(
+	size_t z
+) {
+	pthread_mutex_lock(&lock);
+	struct btee_block *b = free_blocks;
+	if(b) free_blocks = b->next;
+	pthread_mutex_unlock(&lock);
+	if(!b) b = malloc(sizeof(*b) + z);
+	return b;
+}
+
+// with lock held
+static void
+release_block(
+	struct btee_block *b
+) {
+	if(--b->refs == 0) {
+		b->next     = free_blocks;
+		free_blocks = b;
+	}
+}
+
+static int
+write_block(
+	struct btee_file        *fp,
+	struct btee_block const *b
+) {
+	fwrite(b->data, 1, b->n, fp->stream);
+	if(ferror(fp->stream)) {
+		int const r = output_error(fp);
+		if(r == 0) clearerr(fp->stream);
+		return r;
+	}
+	return 0;
+}
+
+static void *
+writer(
+	void *arg
+) {
+	struct btee_file *fp = arg;
+	pthread_mutex_lock(&lock);
+	for(;;) {
+		while(!fp->closed && !halted && !finished && (fp->head == fp->tail)) {
+			pthread_cond_wait(&cond, &lock);
+		}
+		if(fp->closed || halted || (fp->head == fp->tail)) break;
+		struct btee_block *b = fp->queue[fp->head % queue_depth];
+		pthread_mutex_unlock(&lock);
+		int const r = write_block(fp, b);
+		pthread_mutex_lock(&lock);
+		fp->head++;
+		release_block(b);
+		if(r < 0) halted     = true;
+		if(r > 0) fp->closed = true;
+		pthread_cond_broadcast(&cond);
+	}
+	for(; fp->head != fp->tail; fp->head++) {
+		release_block(fp->queue[fp->head % queue_depth]);
+	}
+	bool const closed = fp->closed;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&lock);
+	if(closed) close_output(fp);
+	return NULL;
+}
+
+// with lock held, returns false if the output is no longer open
+static bool
+enqueue(
+	struct btee_file  *fp,
+	struct btee_block *b
+) {
+	while(!fp->closed && !halted && ((fp->tail - fp->head) == queue_depth)) {
+		if(!fp->regular && (policy == POLICY_DROP)) {
+			return true;
+		}
+		if(!fp->regular && (policy == POLICY_CLOSE)) {
+			if(error_messages) errorf("%s: closed, output fell behind", fp->name ? fp->name : "stdout");
+			fp->closed = true;
+			pthread_cond_broadcast(&cond);
+			return false;
+		}
+		pthread_cond_wait(&cond, &lock);
+	}
+	if(fp->closed || halted) {
+		return false;
+	}
+	fp->queue[fp->tail++ % queue_depth] = b;
+	b->refs++;
+	pthread_cond_broadcast(&cond);
+	return true;
+}
+
+static int
+run_threaded(
+	struct btee_file *file,
+	size_t            nfiles,
+	size_t            sizeof_buffer,
+	bool              halt_no_output
+) {
+	int exit_code = EXIT_SUCCESS;
+
+	for(size_t i = 0; i < nfiles; i++) {
+		if(file[i].stream) {
+			file[i].queue    = calloc(queue_depth, sizeof(*file[i].queue));
+			file[i].threaded = file[i].queue && (pthread_create(&file[i].thread, NULL, writer, &file[i]) == 0);
+		}
+	}
+
+	while(!gSignal && (exit_code == EXIT_SUCCESS)) {
+		struct btee_block *b = get_block(sizeof_buffer);
+		if(!b) {
+			if(error_messages) perror();
+			exit_code = EXIT_FAILURE;
+			break;
+		}
+		b->refs = 1;
+		b->n    = fread(b->data, 1, sizeof_buffer, stdin);
+		if(b->n > 0) {
+			size_t o = 0;
+			pthread_mutex_lock(&lock);
+			for(size_t i = 0; i < nfiles; i++) {
+				if(file[i].threaded) {
+					o += enqueue(&file[i], b);
+				}
+			}
+			if(halted) exit_code = EXIT_FAILURE;
+			pthread_mutex_unlock(&lock);
+			// an output without a thread is written in turn, as before
+			for(size_t i = 0; (exit_code == EXIT_SUCCESS) && (i < nfiles); i++) {
+				if(!file[i].threaded && file[i].stream) {
+					int const r = write_block(&file[i], b);
+					if(r < 0) exit_code = EXIT_FAILURE;
+					if(r > 0) close_output(&file[i]);
+					else      o++;
+				}
+			}
+			if((exit_code == EXIT_SUCCESS) && (o == 0) && halt_no_output) {
+				exit_code = EXIT_FAILURE;
+			}
+		}
+		pthread_mutex_lock(&lock);
+		release_block(b);
+		pthread_mutex_unlock(&lock);
+		if(exit_code != EXIT_SUCCESS) break;
+		if(ferror(stdin)) {
+			if(1
+#ifdef EPIPE
+				&& (errno != EPIPE)
+#endif
+			) {
+				if(error_messages) perror();
+			}
+			exit_code = EXIT_FAILURE;
+			break;
+		}
+		if(feof(stdin)) break;
+	}
+
+	pthread_mutex_lock(&lock);
+	finished = true;
+	halted  |= (exit_code != EXIT_SUCCESS);
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&lock);
+	for(size_t i = 0; i < nfiles; i++) {
+		if(file[i].threaded) pthread_join(file[i].thread, NULL);
+		free(file[i].queue);
+	}
+	for(struct btee_block *b; (b = free_blocks) != NULL; ) {
+		free_blocks = b->next;
+		free(b);
+	}
+
+	return halted ? EXIT_FAILURE : exit_code;
+}
+
+//------------------------------------------------------------------------------
+
+#ifdef BTEE_SPLICE
+
+// zero-copy: each block is moved from stdin into a pipe, duplicated into each
+// output with tee, through a pipe of its own for a regular file, and then
+// dropped; only an output left short by a partial tee is finished from a copy.
+// every output is waited for, so this is only for the block policy; drop and
+// close need the queue of blocks each writer thread keeps
+
+static bool
+splice_all(
+	int    in,
+	int    out,
+	size_t n
+) {
+	while(n > 0) {
+		ssize_t const m = splice(in, NULL, out, NULL, n, SPLICE_F_MOVE);
+		if(m <= 0) return false;
+		n -= m;
+	}
+	return true;
+}
+
+static bool
+read_all(
+	int      in,
+	uint8_t *b,
+	size_t   n
+) {
+	while(n > 0) {
+		ssize_t const m = read(in, b, n);
+		if(m <= 0) return false;
+		b += m;
+		n -= m;
+	}
+	return true;
+}
+
+static bool
+write_all(
+	int            out,
+	uint8_t const *b,
+	size_t         n
+) {
+	while(n > 0) {
+		ssize_t const m = write(out, b, n);
+		if(m <= 0) return false;
+		b += m;
+		n -= m;
+	}
+	return true;
+}
+
+static void
+close_pipe(
+	int p[2]
+) {
+	if(p[0] >= 0) close(p[0]);
+	if(p[1] >= 0) close(p[1]);
+	p[0] = p[1] = -1;
+}
+
+static void
+size_pipe(
+	int    p[2],
+	size_t z
+) {
+#ifdef F_SETPIPE_SZ
+	fcntl(p[1], F_SETPIPE_SZ, (int)((z < INT_MAX) ? z : INT_MAX));
+#else
+	(void)p;
+	(void)z;
+#endif
+}
+
+// returns -1 if an output or stdin can not be spliced, before anything has
+// been consumed, otherwise the exit code
+static int
+run_spliced(
+	struct btee_file *file,
+	size_t            nfiles,
+	uint8_t          *buffer,
+	size_t            sizeof_buffer,
+	bool              halt_no_output
+) {
+	int exit_code = -1;
+	int in[2]     = { -1, -1 };
+	int null      = -1;
+
+	for(size_t i = 0; i < nfiles; i++) {
+		file[i].pipe[0] = file[i].pipe[1] = -1;
+	}
+	for(size_t i = 0; i < nfiles; i++) {
+		if(file[i].stream) {
+			struct stat st;
+			file[i].fd = fileno(file[i].stream);
+			if((fstat(file[i].fd, &st) != 0) || (fcntl(file[i].fd, F_GETFL) & O_APPEND)) {
+				goto done;
+			}
+			if(file[i].regular) {
+				if(pipe(file[i].pipe) != 0) goto done;
+				size_pipe(file[i].pipe, sizeof_buffer);
+			} else if(!S_ISFIFO(st.st_mode)) {
+				goto done;
+			}
+		}
+	}
+	if((pipe(in) != 0) || ((null = open("/dev/null", O_WRONLY)) < 0)) {
+		goto done;
+	}
+	size_pipe(in, sizeof_buffer);
+
+	for(bool first = true; !gSignal; first = false) {
+		ssize_t const n = splice(STDIN_FILENO, NULL, in[1], NULL, sizeof_buffer, SPLICE_F_MOVE);
+		if(n < 0) {
+			if(first && (errno == EINVAL)) goto done;
+			if(1
+#ifdef EPIPE
+				&& (errno != EPIPE)
+#endif
+			) {
+				if(error_messages) perror();
+			}
+			exit_code = EXIT_FAILURE;
+			goto done;
+		}
+		exit_code = EXIT_SUCCESS;
+		if(n == 0) break;
+
+		size_t o = 0, short_outputs = 0;
+		for(size_t i = 0; i < nfiles; i++) {
+			struct btee_file *fp = &file[i];
+			if(!fp->stream) continue;
+			ssize_t m = tee(in[0], fp->regular ? fp->pipe[1] : fp->fd, n, 0);
+			int     r = 0;
+			if(m < 0) {
+				m = 0;
+				if(errno != EAGAIN) r = output_error(fp);
+			}
+			if(!r && fp->regular && !splice_all(fp->pipe[0], fp->fd, m)) {
+				r = output_error(fp);
+				// whatever is left in the pipe would go out with the next block
+				close_pipe(fp->pipe);
+				if(!r && (pipe(fp->pipe) != 0)) r = output_error(fp);
+			}
+			if(r < 0) {
+				exit_code = EXIT_FAILURE;
+				goto done;
+			}
+			if(r > 0) {
+				close_output(fp);
+				close_pipe(fp->pipe);
+				continue;
+			}
+			fp->sent = (size_t)m;
+			short_outputs += (fp->sent < (size_t)n);
+			o++;
+		}
+
+		if(short_outputs > 0) {
+			if(!read_all(in[0], buffer, n)) {
+				if(error_messages) perror();
+				exit_code = EXIT_FAILURE;
+				goto done;
+			}
+			for(size_t i = 0; i < nfiles; i++) {
+				struct btee_file *fp = &file[i];
+				if(fp->stream && (fp->sent < (size_t)n) && !write_all(fp->fd, buffer + fp->sent, n - fp->sent)) {
+					int const r = output_error(fp);
+					if(r < 0) {
+						exit_code = EXIT_FAILURE;
+						goto done;
+					}
+					if(r > 0) {
+						close_output(fp);
+						close_pipe(fp->pipe);
+						o--;
+					}
+				}
+			}
+		} else if(!splice_all(in[0], null, n)) {
+			if(error_messages) perror();
+			exit_code = EXIT_FAILURE;
+			goto done;
+		}
+
+		if((o == 0) && halt_no_output) {
+			exit_code = EXIT_FAILURE;
+			goto done;
+		}
+	}
+	if(exit_code < 0) exit_code = EXIT_SUCCESS;
+
+done:
+	for(size_t i = 0; i < nfiles; i++) {
+		close_pipe(file[i].pipe);
+	}
+	close_pipe(in);
+	if(null >= 0) close(null);
+	return exit_code;
+}
+
+#endif//def BTEE_SPLICE
+
+//------------------------------------------------------------------------------
+
 #ifndef NDEBUG
 int
 main(
@@ -82,6 +557,8 @@ main(
 		{  6, "-c, --close-on-error",    "close output on error" },
 		{  7, "-1, --halt-first-error",  "halt on first output error" },
 		{  8, "-0, --halt-no-outputs",   "halt if no active outputs" },
+		{ 10, "-p, --policy POLICY",     "when an output falls behind: block (default), drop or close" },
+		{ 11, "-q, --queue DEPTH",       "queue up to DEPTH buffers for each output" },
 		{ 99, "-I, --ignore-interrupts", "ignore interrupt signals" },
 	};
 	static size_t const n_options = (sizeof(options) / sizeof(options[0]));
@@ -98,9 +575,6 @@ main(
 	bool   append_to_file    = false;
 	bool   ignore_interrupts = false;
 	bool   standard_out      = true;
-	bool   error_messages    = true;
-	bool   close_on_error    = false;
-	bool   halt_first_error  = false;
 	bool   halt_no_output    = false;
 
 	int argi = 1;
@@ -139,6 +613,17 @@ main(
 			case 9:
 				line_buffered = true;
 				break;
+			case 10:
+				policy = setpolicy(argv[argi]);
+				if(policy < 0) {
+					errorf("unknown policy: %s", argv[argi]);
+					return EXIT_FAILURE;
+				}
+				break;
+			case 11:
+				queue_depth = streval(argv[argi], NULL, 0);
+				if(queue_depth == 0) queue_depth = 1;
+				break;
 			case 99:
 				ignore_interrupts = true;
 				break;
@@ -152,10 +637,10 @@ main(
 			;
 	}
 
-	size_t            nfiles = ((argi > 0) && (argc > argi)) ? (argc - argi) + 1 : 0;
+	size_t            nfiles = ((argi < argc) ? (size_t)(argc - argi) : 0) + 1;
 	struct btee_file *file   = calloc(nfiles, sizeof(struct btee_file));
 	uint8_t          *buffer = malloc(sizeof_buffer);
-	if(!(file || buffer)) {
+	if(!(file && buffer)) {
 		if(error_messages) perror();
 		exit(EXIT_FAILURE);
 	}
@@ -180,7 +665,7 @@ main(
 		if(file[i].is_pipe) {
 			file[i].stream = NULL;
 			file[i].name   = ++args;
-			file[i].stream = popen(file[i].name, line_buffered ? "w" : "wb");
+			file[i].stream = popen(file[i].name, line_buffered ? "w" : POPEN_WB);
 		} else {
 			file[i].name   = args;
 			file[i].stream = fopen(file[i].name, append_to_file ? (line_buffered ? "a" : "ab") : (line_buffered ? "w" : "wb"));
@@ -193,37 +678,36 @@ main(
 			}
 		}
 	}
+	for(size_t i = 0; i < nfiles; i++) {
+		struct stat st;
+		file[i].regular = file[i].stream && (fstat(fileno(file[i].stream), &st) == 0) && S_ISREG(st.st_mode);
+	}
 
-	while(!gSignal && (exit_code == EXIT_SUCCESS)) {
-		size_t n;
-		if(line_buffered) {
-			char const *cs = fgets((char *)buffer, sizeof_buffer, stdin);
-			n = cs ? strlen((char *)buffer) : 0;
-		} else {
-			n = fread(buffer, 1, sizeof_buffer, stdin);
+	if(!line_buffered && (exit_code == EXIT_SUCCESS)) {
+#ifdef BTEE_SPLICE
+		exit_code = (policy == POLICY_BLOCK) ? run_spliced(file, nfiles, buffer, sizeof_buffer, halt_no_output) : -1;
+		if(exit_code < 0)
+#endif
+		{
+			exit_code = run_threaded(file, nfiles, sizeof_buffer, halt_no_output);
 		}
-		if(n > 0) {
+	}
+
+	while(line_buffered && !gSignal && (exit_code == EXIT_SUCCESS)) {
+		char const *cs = fgets((char *)buffer, sizeof_buffer, stdin);
+		if(cs) {
 			size_t o = 0;
 			for(size_t i = 0; i < nfiles; i++) {
 				if(file[i].stream) {
-					if(line_buffered) {
-						fputs((char *)buffer, file[i].stream);
-					} else {
-						fwrite(buffer, 1, n, file[i].stream);
-					}
+					fputs(cs, file[i].stream);
 					if(ferror(file[i].stream)) {
-						if(error_messages) perror(file[i].name);
-						if(halt_first_error) {
+						int const r = output_error(&file[i]);
+						if(r < 0) {
 							exit_code = EXIT_FAILURE;
 							break;
 						}
-						if(close_on_error) {
-							if(file[i].is_pipe) {
-								pclose(file[i].stream);
-							} else if(i > 0) {
-								fclose(file[i].stream);
-							}
-							file[i].stream = NULL;
+						if(r > 0) {
+							close_output(&file[i]);
 							continue;
 						}
 						clearerr(file[i].stream);
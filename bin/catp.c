@@ -24,12 +24,24 @@ SOFTWARE.
 
 //------------------------------------------------------------------------------
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
 #include <hol/holibc.h>
 #include <signal.h>
 #ifdef _WIN32
 #include <fcntl.h>
 #include <io.h>
 #endif
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef SPLICE_F_MOVE
+#define CATP_SPLICE  (1)
+#endif
+#endif
 
 //------------------------------------------------------------------------------
 
@@ -111,6 +123,112 @@ egest(
 
 //------------------------------------------------------------------------------
 
+static void (*swapwords)(void *q, void const *p, size_t n) = NULL;
+static size_t swapsize = 1;
+
+static void
+setswapbytes(
+	char const *arg
+) {
+	switch((swapsize = streval(arg, NULL, 0))) {
+	case 2: swapwords = swapbytes16v; return;
+	case 4: swapwords = swapbytes32v; return;
+	case 8: swapwords = swapbytes64v; return;
+	}
+
+	errorf("invalid swap size %s", arg);
+	fail();
+}
+
+//------------------------------------------------------------------------------
+
+#ifdef CATP_SPLICE
+
+// zero-copy: the whole of an input is moved by the kernel, with
+// copy_file_range between regular files, sendfile from a regular file, or
+// splice to or from a pipe; the padding of a trailing partial word is then
+// the only thing written from userspace
+
+#define TRANSFER_CHUNK  ((size_t)1 << 30)
+
+enum {
+	TRANSFER_COPY_FILE_RANGE,
+	TRANSFER_SENDFILE,
+	TRANSFER_SPLICE,
+	N_TRANSFERS
+};
+
+static ssize_t
+transfer_chunk(
+	int way,
+	int in_fd,
+	int out_fd
+) {
+	switch(way) {
+	case TRANSFER_COPY_FILE_RANGE:
+		return copy_file_range(in_fd, NULL, out_fd, NULL, TRANSFER_CHUNK, 0);
+	case TRANSFER_SENDFILE:
+		return sendfile(out_fd, in_fd, NULL, TRANSFER_CHUNK);
+	case TRANSFER_SPLICE:
+		return splice(in_fd, NULL, out_fd, NULL, TRANSFER_CHUNK, SPLICE_F_MOVE);
+	}
+	errno = EINVAL;
+	return -1;
+}
+
+// returns false if nothing applies to this pair, before anything is moved;
+// otherwise *np is the number of bytes moved
+static bool
+transfer(
+	uint64_t *np
+) {
+	int const   in_fd  = fileno(in);
+	int const   out_fd = fileno(out);
+	struct stat si, so;
+	if((fstat(in_fd, &si) != 0) || (fstat(out_fd, &so) != 0)) {
+		return false;
+	}
+	// some pseudo files claim to be empty regular files, and copy nothing
+	bool const regular = S_ISREG(si.st_mode) && (si.st_size > 0);
+	bool const can[N_TRANSFERS] = {
+		[TRANSFER_COPY_FILE_RANGE] = regular && S_ISREG(so.st_mode),
+		[TRANSFER_SENDFILE]        = regular,
+		[TRANSFER_SPLICE]          = S_ISFIFO(si.st_mode) || S_ISFIFO(so.st_mode),
+	};
+	for(int way = 0; way < N_TRANSFERS; way++) {
+		if(!can[way]) continue;
+		uint64_t n = 0;
+		for(;;) {
+			ssize_t const m = transfer_chunk(way, in_fd, out_fd);
+			if(m < 0) {
+				if(errno == EINTR) continue;
+				if(n == 0) break;
+#ifdef EPIPE
+				if(errno != EPIPE)
+#endif
+				{
+					perror(out_name);
+					fail();
+				}
+			}
+			if(m <= 0) {
+				*np = n;
+				return true;
+			}
+			n += m;
+			if(gSignal) {
+				*np = n;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+#endif//def CATP_SPLICE
+
+//------------------------------------------------------------------------------
+
 #ifndef NDEBUG
 int
 main(
@@ -136,6 +254,7 @@ main(
 		{  1, "-h, --help",              "display help" },
 		{  2, "-o, --output FILE",       "output to FILE" },
 		{  3, "-b, --buffer SIZE",       "set buffer SIZE" },
+		{  4, "-x, --swap-bytes SIZE",   "swap the byte order of SIZE (2, 4 or 8) byte words" },
 		{ 99, "-I, --ignore-interrupts", "ignore interrupt signals" },
 	};
 	static size_t const n_options = (sizeof(options) / sizeof(options[0]));
@@ -164,7 +283,7 @@ main(
 				out_name   = argv[argi];
 				out_ispipe = (*out_name == '=');
 				out_name  += out_ispipe;
-				out        = out_ispipe ? popen(out_name, "wb") : fopen(out_name, "wb");
+				out        = out_ispipe ? popen(out_name, POPEN_WB) : fopen(out_name, "wb");
 				if(!out) {
 					perror(out_name);
 					fail();
@@ -174,6 +293,9 @@ main(
 				bufsize = streval(argv[argi], NULL, 0);
 				if(!bufsize) bufsize = BUFSIZE;
 				break;
+			case 4:
+				setswapbytes(argv[argi]);
+				break;
 			case 99:
 				ignore_interrupts = true;
 				break;
@@ -187,6 +309,7 @@ main(
 			;
 	}
 
+	bufsize = (bufsize < swapsize) ? swapsize : (bufsize - (bufsize % swapsize));
 	size_t  const buflen = bufsize / sizeof(BUFF_T);
 	BUFF_T *const buffer = calloc(buflen, sizeof(*buffer));
 	if(!buffer) {
@@ -211,15 +334,28 @@ main(
 			in_name   = argv[argi++];
 			in_ispipe = (*in_name == '=');
 			in_name  += in_ispipe;
-			in        = in_ispipe ? popen(in_name, "rb") : fopen(in_name, "rb");
+			in        = in_ispipe ? popen(in_name, POPEN_RB) : fopen(in_name, "rb");
 			if(!in) {
 				perror(in_name);
 				fail();
 			}
 		}
+#ifdef CATP_SPLICE
+		uint64_t moved;
+		if(!swapwords && (fflush(out) == 0) && transfer(&moved)) {
+			static BUFF_T const zero = 0;
+			size_t const m = moved % sizeof(zero);
+			if((m > 0) && !egest(&zero, sizeof(zero) - m, 1)) {
+				break;
+			}
+			continue;
+		}
+#endif
 		for(size_t n;
 			!gSignal && ((n = ingest(buffer, sizeof(*buffer), buflen)) > 0);
 		) {
+			// a trailing partial word is passed through unswapped
+			if(swapwords) swapwords(buffer, buffer, (n * sizeof(*buffer)) / swapsize);
 			if(!egest(buffer, sizeof(*buffer), n)) {
 				break;
 			}
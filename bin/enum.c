@@ -57,28 +57,38 @@ inchar(
 
 //------------------------------------------------------------------------------
 
-static FILE       *out;
-static char const *out_name   = "";
-static bool        out_ispipe = false;
+static FILE         *out;
+static char const   *out_name   = "";
+static bool          out_ispipe = false;
+static bool          out_istty  = false;
+static struct fmtbuf outb;
 
 static inline int
 outchar(
 	int c
 ) {
-	return fputc(c, out);
+	return fmtbuf_putc(&outb, c);
 }
 
+// a terminal sees each line as it ends, not when the buffer fills
 static inline int
-print(
-	char const *fmt,
-	...
+outeol(
+	void
+) {
+	int const c = fmtbuf_putc(&outb, '\n');
+	if(out_istty) fmtbuf_flush(&outb);
+	return c;
+}
+
+static inline int
+outnum(
+	size_t n,
+	int    width,
+	bool   as_hex
 ) {
-	int r;
-	va_list va;
-	va_start(va, fmt);
-	r = vfprintf(out, fmt, va);
-	va_end(va);
-	return r;
+	as_hex ? fmtbuf_u64hex_padded(&outb, n, width) : fmtbuf_u64dec_padded(&outb, n, width);
+	fmtbuf_putc(&outb, ':');
+	return fmtbuf_putc(&outb, ' ');
 }
 
 //------------------------------------------------------------------------------
@@ -118,7 +128,7 @@ main(
 	in  = stdin;
 	out = stdout;
 
-	int    type              = 'u';
+	bool   as_hex            = false;
 	int    width             = 6;
 	size_t start             = 0;
 	size_t increment         = 1;
@@ -142,14 +152,14 @@ main(
 				out_name   = argv[argi];
 				out_ispipe = (*out_name == '=');
 				out_name  += out_ispipe;
-				out        = out_ispipe ? popen(out_name, "wb") : fopen(out_name, "wb");
+				out        = out_ispipe ? popen(out_name, POPEN_WB) : fopen(out_name, "wb");
 				if(!out) {
 					perror(out_name);
 					fail();
 				}
 				break;
 			case 10:
-				type = 'x';
+				as_hex = true;
 				break;
 			case 11:
 				width = (int)streval(argv[argi], NULL, 0);
@@ -182,9 +192,9 @@ main(
 	_setmode(_fileno(stdin), _O_BINARY);
 	_setmode(_fileno(stdout), _O_BINARY);
 #endif
+	fmtbuf_init(&outb, out);
+	out_istty = isatty(fileno(out));
 	bool eol = true;
-	char fmt[BITS(width)];
-	sprintf(fmt, "%%.%iz%c: ", width, type);
 	do {
 		if(argi < argc) {
 			if(in != stdin) {
@@ -193,21 +203,26 @@ main(
 			in_name   = argv[argi++];
 			in_ispipe = (*in_name == '=');
 			in_name  += in_ispipe;
-			in        = in_ispipe ? popen(in_name, "rb") : fopen(in_name, "rb");
+			in        = in_ispipe ? popen(in_name, POPEN_RB) : fopen(in_name, "rb");
 			if(!in) {
+				fmtbuf_flush(&outb);
 				perror(in_name);
 				fail();
 			}
 		}
 		for(int c; !gSignal && ((c = inchar()) != EOF); ) {
 			if(eol) {
-				print(fmt, start);
+				outnum(start, width, as_hex);
 				start += increment;
 			}
 			eol = (c == '\n');
-			outchar(c);
+			eol ? outeol() : outchar(c);
 		}
 	} while(!gSignal && (argi < argc))
 		;
+	if(fmtbuf_flush(&outb) != 0) {
+		perror(out_name);
+		fail();
+	}
 	return 0;
 }
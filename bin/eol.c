@@ -30,6 +30,9 @@ SOFTWARE.
 #include <fcntl.h>
 #include <io.h>
 #endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 //------------------------------------------------------------------------------
 
@@ -48,11 +51,22 @@ static FILE       *in;
 static char const *in_name   = "";
 static bool        in_ispipe = false;
 
-static inline int
-inchar(
-	void
+static size_t
+ingest(
+	void  *b,
+	size_t n
 ) {
-	return fgetc(in);
+	size_t const u = fread(b, 1, n, in);
+	if(!u && ferror(in)) {
+#ifdef EPIPE
+		if(errno != EPIPE)
+#endif
+		{
+			perror(in_name);
+			fail();
+		}
+	}
+	return u;
 }
 
 //------------------------------------------------------------------------------
@@ -61,11 +75,22 @@ static FILE       *out;
 static char const *out_name   = "";
 static bool        out_ispipe = false;
 
-static inline int
-outchar(
-	int c
+static bool
+egest(
+	void const *b,
+	size_t      n
 ) {
-	return fputc(c, out);
+	if(fwrite(b, 1, n, out) != n) {
+#ifdef EPIPE
+		if(errno != EPIPE)
+#endif
+		{
+			perror(out_name);
+			fail();
+		}
+		return false;
+	}
+	return true;
 }
 
 //------------------------------------------------------------------------------
@@ -96,6 +121,91 @@ geteol(
 	fail();
 }
 
+static char const *const eolstr[] = {
+	[CR]   = "\r",
+	[LF]   = "\n",
+	[CRLF] = "\r\n",
+	[LFCR] = "\n\r",
+};
+
+//------------------------------------------------------------------------------
+
+#define BLOCK_SIZE  (256 Ki)
+
+static inline bool
+iscrlf(
+	int c
+) {
+	return (c == '\r') || (c == '\n');
+}
+
+// the first CR or LF in [p, e), or e
+static inline char const *
+findeol(
+	char const *p,
+	char const *e
+) {
+#if defined(__SSE2__)
+	__m128i const cr = _mm_set1_epi8('\r');
+	__m128i const lf = _mm_set1_epi8('\n');
+	for(; (e - p) >= 16; p += 16) {
+		__m128i  const v = _mm_loadu_si128((__m128i const *)p);
+		uint32_t const m = (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+		if(m) return p + tzcount(m);
+	}
+#else
+	uint64_t const lsbs = UINT64_C(0x0101010101010101);
+	uint64_t const msbs = UINT64_C(0x8080808080808080);
+	for(; (e - p) >= 8; p += 8) {
+		uint64_t v;
+		memcpy(&v, p, sizeof(v));
+		v = leswapbytes(v);
+		// a zero byte of x or y marks a CR or LF; only the first mark is exact
+		uint64_t const x = v ^ (lsbs * '\r');
+		uint64_t const y = v ^ (lsbs * '\n');
+		uint64_t const m = (((x - lsbs) & ~x) | ((y - lsbs) & ~y)) & msbs;
+		if(m) return p + (tzcount(m) >> 3);
+	}
+#endif
+	for(; (p < e) && !iscrlf(*p); p++)
+		;
+	return p;
+}
+
+// converts n bytes from p into q, which has room for 2n; every CR or LF is a
+// line end, and swallows one of the other that directly follows it, even at
+// the start of the next block, so *swallow carries that over, or is -1
+static size_t
+convert(
+	char       *q,
+	char const *p,
+	size_t      n,
+	char const *t,
+	size_t      tn,
+	int        *swallow
+) {
+	char       *const q0 = q;
+	char const *const e  = p + n;
+	if((p < e) && ((unsigned char)*p == *swallow)) p++;
+	*swallow = -1;
+	while(p < e) {
+		char const *const s = findeol(p, e);
+		memcpy(q, p, s - p);
+		q += s - p;
+		if((p = s) == e) break;
+		int const c = *p++;
+		memcpy(q, t, tn);
+		q += tn;
+		int const cc = (c == '\n') ? '\r' : '\n';
+		if(p == e) {
+			*swallow = cc;
+		} else if(*p == cc) {
+			p++;
+		}
+	}
+	return q - q0;
+}
+
 //------------------------------------------------------------------------------
 
 #ifndef NDEBUG
@@ -149,7 +259,7 @@ main(
 				out_name   = argv[argi];
 				out_ispipe = (*out_name == '=');
 				out_name  += out_ispipe;
-				out        = out_ispipe ? popen(out_name, "wb") : fopen(out_name, "wb");
+				out        = out_ispipe ? popen(out_name, POPEN_WB) : fopen(out_name, "wb");
 				if(!out) {
 					perror(out_name);
 					fail();
@@ -173,7 +283,15 @@ main(
 		fail();
 	}
 
-	int const eol = geteol(argv[argi++]);
+	int         const eol  = geteol(argv[argi++]);
+	char const *const t    = eolstr[eol];
+	size_t      const tn   = strlen(t);
+	char       *const ibuf = malloc(BLOCK_SIZE);
+	char       *const obuf = malloc(2 * BLOCK_SIZE);
+	if(!ibuf || !obuf) {
+		perror();
+		fail();
+	}
 
 	if(ignore_interrupts) {
 		signal(SIGINT, SIG_IGN);
@@ -192,41 +310,22 @@ main(
 			in_name   = argv[argi++];
 			in_ispipe = (*in_name == '=');
 			in_name  += in_ispipe;
-			in        = in_ispipe ? popen(in_name, "rb") : fopen(in_name, "rb");
+			in        = in_ispipe ? popen(in_name, POPEN_RB) : fopen(in_name, "rb");
 			if(!in) {
 				perror(in_name);
 				fail();
 			}
 		}
 		bool was_eol = false;
-		for(int c1, c2; !gSignal && ((c1 = inchar()) != EOF); ) {
-			was_eol = (c1 == '\n') || (c1 == '\r');
-			if(was_eol) {
-				int const cc = ((c1 == '\n') ? '\r' : '\n');
-				do {
-					switch(eol) {
-					case LFCR: outchar('\n'); // fallthrough
-					case   CR: outchar('\r'); break;
-					case CRLF: outchar('\r'); // fallthrough
-					case   LF: outchar('\n'); break;
-					}
-					c2 = inchar();
-				} while(c2 == c1)
-					;
-				if((c2 != cc) && (c2 != EOF)) {
-					outchar(c2);
-				}
-			} else {
-				outchar(c1);
+		int  swallow = -1;
+		for(size_t n; !gSignal && ((n = ingest(ibuf, BLOCK_SIZE)) > 0); ) {
+			was_eol = iscrlf(ibuf[n - 1]);
+			if(!egest(obuf, convert(obuf, ibuf, n, t, tn, &swallow))) {
+				break;
 			}
 		}
 		if(!was_eol) {
-			switch(eol) {
-			case LFCR: outchar('\n'); // fallthrough
-			case   CR: outchar('\r'); break;
-			case CRLF: outchar('\r'); // fallthrough
-			case   LF: outchar('\n'); break;
-			}
+			egest(t, tn);
 		}
 	} while(!gSignal && (argi < argc))
 		;
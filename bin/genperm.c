@@ -25,6 +25,7 @@ SOFTWARE.
 //------------------------------------------------------------------------------
 
 #include <hol/holibc.h>
+#include <pthread.h>
 #include <signal.h>
 #ifdef _WIN32
 #include <fcntl.h>
@@ -44,28 +45,37 @@ signal_handler(
 
 //------------------------------------------------------------------------------
 
-static FILE       *out;
-static char const *out_name   = "";
-static bool        out_ispipe = false;
+static FILE         *out;
+static char const   *out_name   = "";
+static bool          out_ispipe = false;
+static bool          out_istty  = false;
+static struct fmtbuf outb;
 
 static inline int
 outchar(
 	int c
 ) {
-	return fputc(c, out);
+	return fmtbuf_putc(&outb, c);
 }
 
+// a terminal sees each line as it ends, not when the buffer fills
 static inline int
-print(
-	char const *fmt,
-	...
+outeol(
+	void
 ) {
-	int r;
-	va_list va;
-	va_start(va, fmt);
-	r = vfprintf(out, fmt, va);
-	va_end(va);
-	return r;
+	int const c = fmtbuf_putc(&outb, '\n');
+	if(out_istty) fmtbuf_flush(&outb);
+	return c;
+}
+
+static inline int
+outword(
+	uint64_t w,
+	int      width
+) {
+	fmtbuf_write(&outb, "0x", 2);
+	fmtbuf_u64HEX_padded(&outb, w, width);
+	return outeol();
 }
 
 //------------------------------------------------------------------------------
@@ -76,9 +86,9 @@ print_permutationN(
 	size_t size
 ) {
 	switch(size) {
-	case  4: print("0x%2.2"  PRIX8 "\n", genperm4 (permutation)); break;
-	case  8: print("0x%6.6"  PRIX32"\n", genperm8 (permutation)); break;
-	case 16: print("0x%16.16"PRIX64"\n", genperm16(permutation)); break;
+	case  4: outword(genperm4 (permutation),  2); break;
+	case  8: outword(genperm8 (permutation),  6); break;
+	case 16: outword(genperm16(permutation), 16); break;
 	}
 }
 
@@ -90,9 +100,10 @@ print_permutation(
 ) {
 	uugenperm(permutation[1], permutation[0], size, index);
 	for(size_t i = 0; i < size; i++) {
-		print("%zu ", index[i]);
+		fmtbuf_u64dec(&outb, index[i]);
+		outchar(' ');
 	}
-	outchar('\n');
+	outeol();
 }
 
 static size_t
@@ -125,6 +136,253 @@ strtoperm(
 
 //------------------------------------------------------------------------------
 
+// --range: only the first permutation of each block is unranked, the rest are
+// stepped to with genperm_next; with -j the blocks are queued to a pool of
+// workers, each formatted into the fmtbuf of its slot, and written out in order
+
+#define MAX_THREADS      (256)
+#define JOBS_PER_THREAD  (2)
+
+struct block {
+	uint64_t      start[2];
+	uint64_t      n;
+	bool          done;
+	struct fmtbuf fb;
+};
+
+struct block_worker {
+	pthread_t          thread;
+	struct block_pool *pool;
+	size_t            *index;
+	size_t            *digit;
+};
+
+struct block_pool {
+	pthread_mutex_t     lock;
+	pthread_cond_t      work;
+	pthread_cond_t      done;
+	bool                quit;
+	bool                word;
+	size_t              size;
+	size_t              n_slots;
+	size_t              n_queued;
+	size_t              n_taken;
+	struct block       *slot;
+	size_t              n_workers;
+	struct block_worker worker[];
+};
+
+static size_t
+permutation_length(
+	size_t size,
+	bool   word
+) {
+	return word ? 19 : ((size * (ndigits(size) + 1)) + 1);
+}
+
+static void
+write_permutation(
+	struct fmtbuf *fb,
+	size_t         size,
+	size_t const   index[size],
+	bool           word
+) {
+	if(word) {
+		int bits, width;
+		switch(size) {
+		case  4: bits = 2; width =  2; break;
+		case  8: bits = 3; width =  6; break;
+		case 16: bits = 4; width = 16; break;
+		default: return;
+		}
+		uint64_t w = 0;
+		for(size_t i = 0; i < size; i++) {
+			w |= (uint64_t)index[i] << (i * bits);
+		}
+		fmtbuf_write(fb, "0x", 2);
+		fmtbuf_u64HEX_padded(fb, w, width);
+	} else {
+		for(size_t i = 0; i < size; i++) {
+			fmtbuf_u64dec(fb, index[i]);
+			fmtbuf_putc(fb, ' ');
+		}
+	}
+	fmtbuf_putc(fb, '\n');
+}
+
+static void
+run_block(
+	struct fmtbuf  *fb,
+	uint64_t const  start[2],
+	uint64_t        n,
+	size_t          size,
+	bool            word,
+	size_t         *index,
+	size_t         *digit
+) {
+	uint64_t h = start[1], l = start[0];
+	uugenperm(h, l, size, index);
+	for(size_t k = size; k-- > 0; ) {
+		if(h) {
+			digit[k] = uudivu(h, l, k + 1, &h, &l);
+		} else {
+			digit[k] = l % (k + 1);
+			l /= k + 1;
+		}
+	}
+	for(uint64_t i = 0; !gSignal && (i < n); i++) {
+		if(i > 0) genperm_next(size, index, digit);
+		write_permutation(fb, size, index, word);
+	}
+}
+
+static void *
+block__worker(
+	void *arg
+) {
+	struct block_worker *w = arg;
+	struct block_pool   *t = w->pool;
+
+	pthread_mutex_lock(&t->lock);
+	for(;;) {
+		while(!t->quit && (t->n_taken == t->n_queued)) {
+			pthread_cond_wait(&t->work, &t->lock);
+		}
+		if(t->quit) break;
+
+		struct block *j = &t->slot[t->n_taken++ % t->n_slots];
+		pthread_mutex_unlock(&t->lock);
+
+		run_block(&j->fb, j->start, j->n, t->size, t->word, w->index, w->digit);
+
+		pthread_mutex_lock(&t->lock);
+		j->done = true;
+		pthread_cond_signal(&t->done);
+	}
+	pthread_mutex_unlock(&t->lock);
+
+	return NULL;
+}
+
+static void
+del_block_pool(
+	struct block_pool *t
+) {
+	if(t) {
+		pthread_mutex_lock(&t->lock);
+		t->quit = true;
+		pthread_cond_broadcast(&t->work);
+		pthread_mutex_unlock(&t->lock);
+		for(size_t i = 0; i < t->n_workers; i++) {
+			pthread_join(t->worker[i].thread, NULL);
+			free(t->worker[i].index);
+			free(t->worker[i].digit);
+		}
+		free(t->slot);
+		pthread_cond_destroy(&t->done);
+		pthread_cond_destroy(&t->work);
+		pthread_mutex_destroy(&t->lock);
+		free(t);
+	}
+}
+
+static struct block_pool *
+new_block_pool(
+	size_t size,
+	bool   word,
+	size_t n_threads
+) {
+	struct block_pool *t = calloc(1, sizeof(*t) + (n_threads * sizeof(t->worker[0])));
+	if(unlikely(!t)) return NULL;
+
+	pthread_mutex_init(&t->lock, NULL);
+	pthread_cond_init(&t->work, NULL);
+	pthread_cond_init(&t->done, NULL);
+	t->size    = size;
+	t->word    = word;
+	t->n_slots = n_threads * JOBS_PER_THREAD;
+	t->slot    = calloc(t->n_slots, sizeof(*t->slot));
+	if(unlikely(!t->slot)) goto error_return;
+	for(size_t i = 0; i < t->n_slots; i++) {
+		fmtbuf_init(&t->slot[i].fb, out);
+	}
+	for(; t->n_workers < n_threads; t->n_workers++) {
+		struct block_worker *w = &t->worker[t->n_workers];
+		w->pool  = t;
+		w->index = calloc(size, sizeof(*w->index));
+		w->digit = calloc(size, sizeof(*w->digit));
+		if(unlikely(!w->index || !w->digit)) goto error_worker;
+		if(pthread_create(&w->thread, NULL, block__worker, w) != 0) goto error_worker;
+	}
+	return t;
+
+error_worker:
+	free(t->worker[t->n_workers].index);
+	free(t->worker[t->n_workers].digit);
+error_return:
+	del_block_pool(t);
+	return NULL;
+}
+
+static void
+print_range(
+	uint64_t start[2],
+	uint64_t count,
+	size_t   size,
+	bool     word,
+	size_t   n_threads
+) {
+	// a block must fit its slot's fmtbuf, which is then never flushed by the
+	// worker, but moved out whole here
+	size_t const       per = FMTBUF_SIZE / permutation_length(size, word);
+	struct block_pool *t   = ((n_threads > 1) && (per > 0)) ? new_block_pool(size, word, n_threads) : NULL;
+	if(!t) {
+		size_t *index = calloc(size, sizeof(*index));
+		size_t *digit = calloc(size, sizeof(*digit));
+		if(!index || !digit) {
+			fmtbuf_flush(&outb);
+			perror();
+			fail();
+		}
+		run_block(&outb, start, count, size, word, index, digit);
+		free(index);
+		free(digit);
+		return;
+	}
+
+	pthread_mutex_lock(&t->lock);
+	for(size_t n_written = 0; ; ) {
+		for(; !gSignal && (count > 0) && ((t->n_queued - n_written) < t->n_slots); t->n_queued++) {
+			struct block *j = &t->slot[t->n_queued % t->n_slots];
+			j->start[0] = start[0];
+			j->start[1] = start[1];
+			j->n        = (count < per) ? count : per;
+			j->done     = false;
+			uuaddu(start[1], start[0], j->n, &start[1], &start[0]);
+			count -= j->n;
+			pthread_cond_signal(&t->work);
+		}
+		if(n_written == t->n_queued) break;
+
+		struct block *j = &t->slot[n_written % t->n_slots];
+		while(!j->done) {
+			pthread_cond_wait(&t->done, &t->lock);
+		}
+		pthread_mutex_unlock(&t->lock);
+
+		fmtbuf_move(&outb, &j->fb);
+		if(out_istty) fmtbuf_flush(&outb);
+
+		pthread_mutex_lock(&t->lock);
+		n_written++;
+	}
+	pthread_mutex_unlock(&t->lock);
+
+	del_block_pool(t);
+}
+
+//------------------------------------------------------------------------------
+
 #ifndef NDEBUG
 int
 main(
@@ -150,6 +408,8 @@ main(
 		{  1, "-h, --help",              "display help" },
 		{  2, "-o, --output FILE",       "output to FILE" },
 		{ 10, "-w, --word",              "ouput as a single integer word" },
+		{ 11, "-r, --range START COUNT", "output COUNT permutations in rank order from START" },
+		{ 12, "-j, --jobs N",            "generate a --range with N threads" },
 		{ 99, "-I, --ignore-interrupts", "ignore interrupt signals" },
 	};
 	static size_t const n_options = (sizeof(options) / sizeof(options[0]));
@@ -158,8 +418,11 @@ main(
 
 	out = stdout;
 
-	bool output_integer_word = false;
-	bool ignore_interrupts   = false;
+	bool        output_integer_word = false;
+	bool        ignore_interrupts   = false;
+	char const *range_start         = NULL;
+	char const *range_count         = NULL;
+	size_t      n_threads           = 1;
 
 	int argi = 1;
 	while((argi < argc) && (*argv[argi] == '-')) {
@@ -179,7 +442,7 @@ main(
 				out_name   = argv[argi];
 				out_ispipe = (*out_name == '=');
 				out_name  += out_ispipe;
-				out        = out_ispipe ? popen(out_name, "wb") : fopen(out_name, "wb");
+				out        = out_ispipe ? popen(out_name, POPEN_WB) : fopen(out_name, "wb");
 				if(!out) {
 					perror(out_name);
 					fail();
@@ -188,6 +451,17 @@ main(
 			case 10:
 				output_integer_word = true;
 				break;
+			case 11:
+				range_start = argv[argi];
+				range_count = argv[argi + 1];
+				break;
+			case 12:
+				n_threads = streval(argv[argi], NULL, 0);
+				if((n_threads == 0) || (n_threads > MAX_THREADS)) {
+					errorf("invalid thread count: %s", argv[argi]);
+					fail();
+				}
+				break;
 			case 99:
 				ignore_interrupts = true;
 				break;
@@ -215,7 +489,15 @@ main(
 	_setmode(_fileno(stdin), _O_BINARY);
 	_setmode(_fileno(stdout), _O_BINARY);
 #endif
-	if(output_integer_word) {
+	fmtbuf_init(&outb, out);
+	out_istty = isatty(fileno(out));
+	if(range_start) {
+		uint64_t       start[2];
+		size_t   const size  = strtozs(argv[argi++], NULL, 0);
+		uint64_t const count = strtoulls(range_count, NULL, 0);
+		strtoperm(range_start, NULL, 0, start);
+		print_range(start, count, size, output_integer_word, n_threads);
+	} else if(output_integer_word) {
 		size_t       permutation;
 		size_t const size  = strtozs(argv[argi++], NULL, 0);
 		if(argi == argc) {
@@ -384,5 +666,9 @@ main(
 		}
 	}
 
+	if(fmtbuf_flush(&outb) != 0) {
+		perror(out_name);
+		fail();
+	}
 	return 0;
 }
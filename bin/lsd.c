@@ -326,7 +326,7 @@ main(
 				out_name   = argv[argi];
 				out_ispipe = (*out_name == '=');
 				out_name  += out_ispipe;
-				out        = out_ispipe ? popen(out_name, "b") : fopen(out_name, "w");
+				out        = out_ispipe ? popen(out_name, "w") : fopen(out_name, "w");
 				if(!out) {
 					perror(out_name);
 					fail();
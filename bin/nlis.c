@@ -24,8 +24,10 @@ SOFTWARE.
 
 //------------------------------------------------------------------------------
 
+#define HOL_PIPELINE_H__IMPLEMENTATION  (1)
 #include <hol/holibc.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include <signal.h>
 #ifdef _WIN32
 #include <fcntl.h>
@@ -49,13 +51,7 @@ static FILE       *in;
 static char const *in_name   = "";
 static bool        in_ispipe = false;
 
-static inline size_t
-ingest(
-	uint64_t *w,
-	size_t    n
-) {
-	return fread(w, sizeof(*w), n, in);
-}
+static void (*ldwords)(void const *p, void *q, size_t n) = NULL;
 
 //------------------------------------------------------------------------------
 
@@ -63,16 +59,45 @@ static FILE       *out;
 static char const *out_name   = "";
 static bool        out_ispipe = false;
 
+static void (*stwords)(void const *q, void *p, size_t n) = NULL;
+
 static inline size_t
 egest(
 	uint64_t *w,
 	size_t    n
 ) {
+	if(stwords) stwords(w, w, n);
 	return fwrite(w, sizeof(*w), n, out);
 }
 
 //------------------------------------------------------------------------------
 
+static void
+setbyteorder(
+	char const *arg
+) {
+	if(streq(arg, "le") || streq(arg, "LE")) {
+		ldwords = ldu64le_array;
+		stwords = stu64le_array;
+		return;
+	}
+	if(streq(arg, "be") || streq(arg, "BE")) {
+		ldwords = ldu64be_array;
+		stwords = stu64be_array;
+		return;
+	}
+	if(streq(arg, "native")) {
+		ldwords = NULL;
+		stwords = NULL;
+		return;
+	}
+
+	errorf("unknown byte order %s", arg);
+	fail();
+}
+
+//------------------------------------------------------------------------------
+
 #define NKEYS  (4)
 #define NPERMS (4*3*2)
 
@@ -90,6 +115,461 @@ permute(
 
 //------------------------------------------------------------------------------
 
+// the cipher is a chain: every word steps the key schedule, and feeds into the
+// state (x, w) used for the next word
+
+struct cipher {
+	int      rounds;
+	uint64_t salt;
+	size_t   purge;
+	uint64_t key[NKEYS];
+	size_t   perm[NPERMS][NKEYS];
+};
+
+struct chain {
+	uint64_t x, w, u;
+	size_t   y;
+	size_t   index[NPERMS];
+};
+
+static inline uint64_t
+chain_key(
+	struct cipher const *cp,
+	struct chain        *sp
+) {
+	if(sp->y == 0) permute(sp->x, sp->w, sp->index);
+	uint64_t const k = cp->key[cp->perm[sp->index[sp->y / NKEYS]][sp->y % NKEYS]];
+	sp->y = (sp->y + 1) % (NPERMS * NKEYS);
+	return k;
+}
+
+static void
+chain_init(
+	struct cipher const *cp,
+	struct chain        *sp,
+	uint64_t             x,
+	uint64_t             w
+) {
+	sp->x = x;
+	sp->w = w;
+	sp->u = rotr(w|1, msbit(w|1)-1);
+	sp->y = 0;
+	for(size_t i = cp->purge; i-- > 0; ) {
+		sp->x ^= chain_key(cp, sp);
+		sp->w += sp->u;
+	}
+	chain_key(cp, sp);
+	chain_key(cp, sp);
+}
+
+static inline uint64_t
+chain_encrypt(
+	struct cipher const *cp,
+	struct chain        *sp,
+	uint64_t             p
+) {
+	uint64_t const k0 = chain_key(cp, sp);
+	uint64_t const k1 = chain_key(cp, sp);
+	uint64_t const e  = nlis64(p + (sp->w += sp->u), k0, cp->rounds);
+	uint64_t const c  = nlis64(e ^ sp->x, k1, cp->rounds);
+	sp->x += e;
+	return c;
+}
+
+static inline uint64_t
+chain_decrypt(
+	struct cipher const *cp,
+	struct chain        *sp,
+	uint64_t             c
+) {
+	uint64_t const k0 = chain_key(cp, sp);
+	uint64_t const k1 = chain_key(cp, sp);
+	uint64_t const e  = ulis64(c, k1, cp->rounds) ^ sp->x;
+	uint64_t const p  = ulis64(e, k0, cp->rounds) - (sp->w += sp->u);
+	sp->x += e;
+	return p;
+}
+
+//------------------------------------------------------------------------------
+
+// container: a header of CONTAINER_MAGIC and the chunk size, the chunks, and
+// a trailer of the plain text size, all little-endian; every chunk starts a
+// new chain from (salt, key, chunk number), so chunks can be processed in any
+// order, on any number of threads, and any range decrypted on its own
+
+#define CONTAINER_MAGIC  "NLISCTR1"
+#define MAX_THREADS      (256)
+
+struct chunk {
+	pthread_t            thread;
+	bool                 threaded;
+	struct cipher const *cp;
+	uint64_t             number;
+	uint64_t            *w;
+	size_t               z;
+};
+
+static void
+chunk_chain(
+	struct chunk const *c,
+	struct chain       *sp
+) {
+	struct cipher const *cp = c->cp;
+	chain_init(cp, sp,
+		nlis64(cp->salt, cp->key[0], cp->rounds) ^ nlis64(c->number, cp->key[2], cp->rounds),
+		nlis64(cp->salt, cp->key[1], cp->rounds) + nlis64(c->number, cp->key[3], cp->rounds)
+	);
+}
+
+static void *
+encrypt_chunk(
+	void *arg
+) {
+	struct chunk *c = arg;
+	struct chain  s;
+	size_t const  n = (c->z + 7) / 8;
+	memset((uint8_t *)c->w + c->z, 0, (n * 8) - c->z);
+	ldu64be_array(c->w, c->w, n);
+	chunk_chain(c, &s);
+	for(size_t i = 0; i < n; i++) {
+		c->w[i] = chain_encrypt(c->cp, &s, c->w[i]);
+	}
+	stu64le_array(c->w, c->w, n);
+	return NULL;
+}
+
+static void *
+decrypt_chunk(
+	void *arg
+) {
+	struct chunk *c = arg;
+	struct chain  s;
+	size_t const  n = (c->z + 7) / 8;
+	ldu64le_array(c->w, c->w, n);
+	chunk_chain(c, &s);
+	for(size_t i = 0; i < n; i++) {
+		c->w[i] = chain_decrypt(c->cp, &s, c->w[i]);
+	}
+	stu64be_array(c->w, c->w, n);
+	return NULL;
+}
+
+static void
+run_chunks(
+	struct chunk *c,
+	size_t        n,
+	void       *(*fn)(void *)
+) {
+	for(size_t i = 0; i < n; i++) {
+		c[i].threaded = (i > 0) && (pthread_create(&c[i].thread, NULL, fn, &c[i]) == 0);
+	}
+	for(size_t i = 0; i < n; i++) {
+		if(c[i].threaded) {
+			pthread_join(c[i].thread, NULL);
+		} else {
+			fn(&c[i]);
+		}
+	}
+}
+
+static void
+write_chunk(
+	struct chunk const *c,
+	size_t              lo,
+	size_t              hi
+) {
+	if(fwrite((uint8_t *)c->w + lo, 1, hi - lo, out) != (hi - lo)) {
+		perror(out_name);
+		fail();
+	}
+}
+
+static void
+invalid_container(
+	void
+) {
+	errorf("%s: not an nlis container", *in_name ? in_name : "stdin");
+	fail();
+}
+
+static void
+encrypt_container(
+	struct cipher const *cp,
+	size_t               chunk_size,
+	size_t               n_threads
+) {
+	struct chunk   c[MAX_THREADS] = { 0 };
+	uint64_t const cw = chunk_size / 8;
+	uint64_t *const b = malloc(n_threads * cw * sizeof(*b));
+	if(!b) {
+		perror();
+		fail();
+	}
+
+	uint64_t h[2];
+	memcpy(&h[0], CONTAINER_MAGIC, 8);
+	stu64le(&(uint64_t){ chunk_size }, &h[1]);
+	if(fwrite(h, 8, 2, out) != 2) {
+		perror(out_name);
+		fail();
+	}
+
+	uint64_t size = 0, number = 0;
+	for(size_t got = n_threads * chunk_size; !gSignal && (got == (n_threads * chunk_size)); ) {
+		got = fread(b, 1, n_threads * chunk_size, in);
+		if(ferror(in)) {
+			perror(in_name);
+			fail();
+		}
+		size_t m = 0;
+		for(size_t o = 0; o < got; o += chunk_size, m++) {
+			c[m].cp     = cp;
+			c[m].number = number++;
+			c[m].w      = b + (m * cw);
+			c[m].z      = ((got - o) < chunk_size) ? (got - o) : chunk_size;
+		}
+		run_chunks(c, m, encrypt_chunk);
+		for(size_t i = 0; i < m; i++) {
+			write_chunk(&c[i], 0, ((c[i].z + 7) / 8) * 8);
+		}
+		size += got;
+	}
+
+	stu64le(&size, &h[0]);
+	if(fwrite(h, 8, 1, out) != 1) {
+		perror(out_name);
+		fail();
+	}
+	free(b);
+}
+
+static void
+decrypt_container(
+	struct cipher const *cp,
+	size_t               n_threads,
+	bool                 ranged,
+	uint64_t             offset,
+	uint64_t             length
+) {
+	struct chunk c[MAX_THREADS] = { 0 };
+	uint64_t     h[2];
+	if((fread(h, 8, 2, in) != 2) || (memcmp(&h[0], CONTAINER_MAGIC, 8) != 0)) {
+		invalid_container();
+	}
+	uint64_t chunk_size;
+	ldu64le(&h[1], &chunk_size);
+	if(!chunk_size || (chunk_size % 8) || (chunk_size > (SIZE_MAX / MAX_THREADS))) {
+		invalid_container();
+	}
+	uint64_t const cw = chunk_size / 8;
+	uint64_t *const b = malloc(((n_threads * cw) + 2) * sizeof(*b));
+	if(!b) {
+		perror();
+		fail();
+	}
+
+	if(ranged) {
+		// the trailer gives the size, the offset gives the first chunk
+		uint64_t size;
+		if((fseeko(in, -8, SEEK_END) != 0) || (fread(&size, 8, 1, in) != 1)) {
+			perror(in_name);
+			fail();
+		}
+		ldu64le(&size, &size);
+		uint64_t const end = ((offset < size) && (length < (size - offset))) ? (offset + length) : size;
+		uint64_t       number = offset / chunk_size;
+		if(offset >= end) {
+			// nothing to undo
+			free(b);
+			return;
+		}
+		if(fseeko(in, (off_t)(16 + (number * chunk_size)), SEEK_SET) != 0) {
+			perror(in_name);
+			fail();
+		}
+		while(!gSignal && ((number * chunk_size) < end)) {
+			size_t m = 0;
+			for(; (m < n_threads) && ((number * chunk_size) < end); m++, number++) {
+				uint64_t const o = number * chunk_size;
+				c[m].cp     = cp;
+				c[m].number = number;
+				c[m].w      = b + (m * cw);
+				c[m].z      = ((size - o) < chunk_size) ? (size - o) : chunk_size;
+				size_t const n = (c[m].z + 7) / 8;
+				if(fread(c[m].w, 8, n, in) != n) invalid_container();
+			}
+			run_chunks(c, m, decrypt_chunk);
+			for(size_t i = 0; i < m; i++) {
+				uint64_t const o = c[i].number * chunk_size;
+				write_chunk(&c[i],
+					(offset > o) ? (offset - o) : 0,
+					((end - o) < c[i].z) ? (end - o) : c[i].z
+				);
+			}
+		}
+		free(b);
+		return;
+	}
+
+	// streaming, the last word is the trailer; a round is only known to be
+	// all whole chunks once two more words follow it, so two are held back
+	uint64_t number = 0;
+	size_t   held   = 0;
+	for(bool done = false; !gSignal && !done; ) {
+		size_t const r = (n_threads * cw) + 2;
+		size_t const t = fread(b + held, 8, r - held, in) + held;
+		if(ferror(in)) {
+			perror(in_name);
+			fail();
+		}
+		size_t   d = r - 2;
+		uint64_t z = d * 8;
+		if((done = (t < r))) {
+			if(t == 0) invalid_container();
+			d = t - 1;
+			ldu64le(&b[d], &z);
+			if((z < (number * chunk_size)) || ((((z - (number * chunk_size)) + 7) / 8) != d)) {
+				invalid_container();
+			}
+			z -= number * chunk_size;
+		}
+		size_t m = 0;
+		for(size_t o = 0; o < d; o += cw, m++) {
+			c[m].cp     = cp;
+			c[m].number = number++;
+			c[m].w      = b + o;
+			c[m].z      = ((z - (o * 8)) < chunk_size) ? (z - (o * 8)) : chunk_size;
+		}
+		run_chunks(c, m, decrypt_chunk);
+		for(size_t i = 0; i < m; i++) {
+			write_chunk(&c[i], 0, c[i].z);
+		}
+		if(!done) {
+			b[0] = b[d];
+			b[1] = b[d + 1];
+			held = 2;
+		}
+	}
+	free(b);
+}
+
+//------------------------------------------------------------------------------
+
+// stream: the plain format is a single chain over the whole input, passed a
+// buffer at a time through a pipeline; the output is padded with counting
+// words out to a whole number of buffers, with at least one word of padding
+
+#define PIPELINE_DEPTH  (4)
+
+struct stream {
+	struct cipher const *cp;
+	struct chain         chain;
+	size_t               buflen;
+};
+
+static size_t
+read_stream(
+	void  *ctx,
+	void  *b,
+	size_t z
+) {
+	(void)ctx;
+	if(gSignal) return 0;
+	size_t const n = fread(b, 1, z, in);
+	return ferror(in) ? SIZE_MAX : n;
+}
+
+static bool
+write_stream(
+	void  *ctx,
+	void  *b,
+	size_t n
+) {
+	(void)ctx;
+	return fwrite(b, 1, n, out) == n;
+}
+
+static size_t
+encrypt_stream(
+	void  *ctx,
+	void  *out,
+	void  *in,
+	size_t n,
+	bool   last
+) {
+	struct stream *sp = ctx;
+	uint64_t      *p  = in;
+	uint64_t      *c  = out;
+	size_t         m  = (n + 7) / 8;
+	if(gSignal) return 0;
+	memset((uint8_t *)in + n, 0, (m * 8) - n);
+	ldu64be_array(p, p, m);
+	for(size_t i = 0; i < m; i++) {
+		c[i] = chain_encrypt(sp->cp, &sp->chain, p[i]);
+	}
+	if(last) {
+		// the last block is always short of a whole buffer
+		for(uint64_t j = 1; m < sp->buflen; j++) {
+			c[m++] = chain_encrypt(sp->cp, &sp->chain, j);
+		}
+	}
+	if(stwords) stwords(c, c, m);
+	return m * 8;
+}
+
+static size_t
+decrypt_stream(
+	void  *ctx,
+	void  *out,
+	void  *in,
+	size_t n,
+	bool   last
+) {
+	struct stream *sp = ctx;
+	uint64_t      *c  = in;
+	uint64_t      *p  = out;
+	size_t const   m  = n / 8;
+	(void)last;
+	if(gSignal) return 0;
+	if(ldwords) ldwords(c, c, m);
+	for(size_t i = 0; i < m; i++) {
+		p[i] = chain_decrypt(sp->cp, &sp->chain, c[i]);
+	}
+	stu64be_array(p, p, m);
+	return m * 8;
+}
+
+static void
+run_stream(
+	struct cipher const *cp,
+	size_t               bufsize,
+	bool                 undo
+) {
+	struct stream s = {
+		.cp     = cp,
+		.buflen = bufsize / 8,
+	};
+	chain_init(cp, &s.chain,
+		nlis64(cp->salt, cp->key[0], cp->rounds),
+		nlis64(cp->salt, cp->key[1], cp->rounds)
+	);
+	struct pipeline p = {
+		.in_size   = bufsize,
+		.out_size  = bufsize,
+		.depth     = PIPELINE_DEPTH,
+		.read      = read_stream,
+		.transform = undo ? decrypt_stream : encrypt_stream,
+		.write     = write_stream,
+		.ctx       = &s,
+	};
+	if(pipeline_run(&p) != 0) {
+		perror(ferror(out) ? out_name : in_name);
+		fail();
+	}
+}
+
+//------------------------------------------------------------------------------
+
 #ifndef NDEBUG
 int
 main(
@@ -115,7 +595,11 @@ main(
 		{  1, "-h, --help",              "display help" },
 		{  2, "-o, --output FILE",       "output to FILE" },
 		{  3, "-b, --buffer SIZE",       "set buffer SIZE" },
+		{  4, "--byte-order ORDER",      "words are in ORDER: le, be or native (default)" },
 		{ 10, "-u, --undo",              "undo" },
+		{ 11, "-C, --container",         "use the chunked container format, with chunks of the buffer SIZE" },
+		{ 12, "-j, --jobs N",            "process container chunks with N threads" },
+		{ 13, "--offset OFFSET SIZE",    "undo only SIZE bytes from OFFSET of a container FILE" },
 		{ 19, "-c, --counter COUNT",     "generate COUNT numbers" },
 		{ 99, "-I, --ignore-interrupts", "ignore interrupt signals" },
 		{  0, "", NULL },
@@ -130,10 +614,15 @@ main(
 	in  = stdin;
 	out = stdout;
 
-	bool   undo              = false;
-	bool   ignore_interrupts = false;
-	size_t bufsize           = BUFSIZE;
-	size_t counter           = 0;
+	bool     undo              = false;
+	bool     container         = false;
+	bool     ranged            = false;
+	bool     ignore_interrupts = false;
+	size_t   bufsize           = BUFSIZE;
+	size_t   counter           = 0;
+	size_t   n_threads         = 1;
+	uint64_t offset            = 0;
+	uint64_t length            = 0;
 
 	int argi = 1;
 	while((argi < argc) && (*argv[argi] == '-')) {
@@ -153,7 +642,7 @@ main(
 				out_name   = argv[argi];
 				out_ispipe = (*out_name == '=');
 				out_name  += out_ispipe;
-				out        = out_ispipe ? popen(out_name, "wb") : fopen(out_name, "wb");
+				out        = out_ispipe ? popen(out_name, POPEN_WB) : fopen(out_name, "wb");
 				if(!out) {
 					perror(out_name);
 					fail();
@@ -163,9 +652,29 @@ main(
 				bufsize = streval(argv[argi], NULL, 0);
 				bufsize = (bufsize + 7 + !bufsize) & ~(size_t)7;
 				break;
+			case 4:
+				setbyteorder(argv[argi]);
+				break;
 			case 10:
 				undo = true;
 				break;
+			case 11:
+				container = true;
+				break;
+			case 12:
+				n_threads = streval(argv[argi], NULL, 0);
+				if((n_threads == 0) || (n_threads > MAX_THREADS)) {
+					errorf("invalid thread count: %s", argv[argi]);
+					fail();
+				}
+				break;
+			case 13:
+				offset    = streval(argv[argi], NULL, 0);
+				length    = streval(argv[argi + 1], NULL, 0);
+				ranged    = true;
+				container = true;
+				undo      = true;
+				break;
 			case 19:
 				counter = streval(argv[argi], NULL, 0);
 				break;
@@ -211,134 +720,83 @@ main(
 		in_name   = argv[argi++];
 		in_ispipe = (*in_name == '=');
 		in_name  += in_ispipe;
-		in        = in_ispipe ? popen(in_name, "rb") : fopen(in_name, "rb");
+		in        = in_ispipe ? popen(in_name, POPEN_RB) : fopen(in_name, "rb");
 		if(!in) {
 			perror(in_name);
 			fail();
 		}
 	}
 
-	int             rounds = 11;
-	uint64_t        salt   = 0;
-	size_t          size   = 0;
-	uint64_t        key[NKEYS];
-	size_t          perm[NPERMS][NKEYS];
-	size_t          index[NPERMS];
+	static struct cipher cipher = { .rounds = 11 };
+	uint64_t *const key         = cipher.key;
 	char     const *non_integer;
 	uint64_t        k = strtoull(non_integer = rsk, &rsk, 0);
 	if(*rsk == ':') {
-		rounds = (k > INT_MAX) ? INT_MAX : (int)k;
-		if(rounds < 1) rounds = 11;
-		k      = strtoull(non_integer = rsk+1, &rsk, 0);
+		cipher.rounds = (k > INT_MAX) ? INT_MAX : (int)k;
+		if(cipher.rounds < 1) cipher.rounds = 11;
+		k             = strtoull(non_integer = rsk+1, &rsk, 0);
 	}
 	if(*rsk == '/') {
-		salt = k;
-		k    = strtoull(non_integer = rsk+1, &rsk, 0);
+		cipher.salt = k;
+		k           = strtoull(non_integer = rsk+1, &rsk, 0);
 	}
 	if(rsk == non_integer) {
-		xrand_init(rsk, sizeof(key), key);
+		xrand_init(rsk, sizeof(cipher.key), key);
 		for(size_t i = 0; i < NKEYS; i++) {
-			key[i] ^= genperm16(key[i] ^ salt);
+			key[i] ^= genperm16(key[i] ^ cipher.salt);
 		}
 	} else {
 		for(size_t i = 0; i < NKEYS; i++) {
-			key[i] = k = genperm16(k ^ salt) ^ k;
+			key[i] = k = genperm16(k ^ cipher.salt) ^ k;
 			if(*rsk == '.') {
 				k = strtoull(rsk+1, &rsk, 0);
 			}
 		}
 	}
 	for(size_t i = 0; i < NPERMS; i++) {
-		genperm(i, NKEYS, perm[i]);
-	}
-
-	uint64_t x = nlis64(salt, key[0], rounds), w = nlis64(salt, key[1], rounds);
-	uint64_t u = rotr(w|1, msbit(w|1)-1);
-	size_t   y = 0;
-#	define KEY(...)  ( \
-		(y == 0) ? permute(x, w, index) : 0, \
-		k = key[perm[index[y / NKEYS]][y % NKEYS]], \
-		y = (y + 1) % (NPERMS * NKEYS), \
-		k \
-	)
+		genperm(i, NKEYS, cipher.perm[i]);
+	}
 	if(*rsk == '-') {
-		for(size_t i = streval(rsk + 1, NULL, 0); i-- > 0; ) {
-			x ^= KEY();
-			w += u;
-		}
+		cipher.purge = streval(rsk + 1, NULL, 0);
 	}
-	uint64_t k0 = KEY();
-	uint64_t k1 = KEY();
-	uint64_t c = 0, e = 0;
-	size_t   n = 0;
-#	define EGEST(...)  do { \
-		k0 = KEY(); \
-		k1 = KEY(); \
-		e = nlis64((__VA_ARGS__) + (w += u), k0, rounds); \
-		buffer[n++] = nlis64(e ^ x, k1, rounds); \
-		if(n == buflen) { \
-			egest(buffer, n); \
-			size += bufsize; \
-			n = 0; \
-		} \
-		x += e; \
-	} while(0)
-#	define INGEST(...)  ( \
-		k0 = KEY(), \
-		k1 = KEY(), \
-		e = ulis64(buffer[i], k1, rounds) ^ x, \
-		ulis64(e, k0, rounds) - (w += u) \
-	)
-	if(counter > 0) {
-		for(size_t i = 0; !gSignal && (i < counter); i++) {
-			EGEST(i);
-		}
-		if(!gSignal && (n > 0)) {
-			egest(buffer, n);
-		}
-	} else if(undo) {
-		for(bool done = false;
-			!gSignal && !done && ((n = ingest(buffer, buflen)) > 0);
-		) {
-			size_t m = 0;
-			for(size_t i = 0; !gSignal && !done && (i < n); i++) {
-				char  *t = (char *)&buffer[i];
-				size_t z = 8;
-				c = INGEST(buffer[i]);
-				for(char *s = &t[8]; s > t; c >>= 8) {
-					int ch = c & 0xFF;
-					*--s = ch;
-				}
-				x += e;
-				m += z;
-			}
-			fwrite(buffer, 1, m, out);
-		}
-	} else {
-		size_t i = 0;
-		for(int ch; !gSignal && ((ch = getchar()) != EOF); ) {
-			c = (c << 8) | (ch & 0xFFu);
-			if(i++ == 7) {
-				EGEST(c);
-				c = 0;
-				i = 0;
-			}
+
+	if(container) {
+		if(undo) {
+			decrypt_container(&cipher, n_threads, ranged, offset, length);
+		} else {
+			encrypt_container(&cipher, bufsize, n_threads);
 		}
-		if(!gSignal && (i > 0)) {
-			EGEST(c << ((8 - i) * 8));
+		if(fflush(out) != 0) {
+			perror(out_name);
+			fail();
 		}
-		size_t const SIZE = size + (bufsize - (size % bufsize));
-		if(!gSignal && (size < SIZE)) {
-			for(uint64_t j = 1; !gSignal && (size < SIZE); j++) {
-				EGEST(j);
-			}
+		return 0;
+	}
+
+	if(counter == 0) {
+		run_stream(&cipher, bufsize, undo);
+		if(fflush(out) != 0) {
+			perror(out_name);
+			fail();
 		}
-		if(!gSignal && (n > 0)) {
+		return 0;
+	}
+
+	struct chain chain;
+	chain_init(&cipher, &chain,
+		nlis64(cipher.salt, key[0], cipher.rounds),
+		nlis64(cipher.salt, key[1], cipher.rounds)
+	);
+	size_t n = 0;
+	for(size_t i = 0; !gSignal && (i < counter); i++) {
+		buffer[n++] = chain_encrypt(&cipher, &chain, i);
+		if(n == buflen) {
 			egest(buffer, n);
+			n = 0;
 		}
 	}
-#undef INGEST
-#undef EGEST
-#undef KEY
+	if(!gSignal && (n > 0)) {
+		egest(buffer, n);
+	}
 	return 0;
 }
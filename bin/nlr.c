@@ -59,7 +59,9 @@ SOFTWARE.
 //------------------------------------------------------------------------------
 
 #define BASE64__UTF8_MAP (1)
+#define HOL_PIPELINE_H__IMPLEMENTATION  (1)
 #include <hol/holibc.h>
+#include <stddef.h>
 #ifdef _WIN32
 #include <fcntl.h>
 #include <io.h>
@@ -73,6 +75,10 @@ MWNLIS(512)
 enum { ROUNDS = 47 };
 #endif
 
+#ifndef PIPELINE_DEPTH
+enum { PIPELINE_DEPTH = 4 };
+#endif
+
 static inline void memzero(void *p, size_t n) {
 #ifdef _WIN32
 	SecureZeroMemory(p, n);
@@ -82,195 +88,192 @@ static inline void memzero(void *p, size_t n) {
 #endif
 }
 
-static inline uint64_t uint64frombytes(uint8_t const b[8]) {
-	return ((uint64_t)b[0] <<  0)
-	|      ((uint64_t)b[1] <<  8)
-	|      ((uint64_t)b[2] << 16)
-	|      ((uint64_t)b[3] << 24)
-	|      ((uint64_t)b[4] << 32)
-	|      ((uint64_t)b[5] << 40)
-	|      ((uint64_t)b[6] << 48)
-	|      ((uint64_t)b[7] << 56)
-	;
-}
-
-static inline void uint64tobytes(uint64_t u, uint8_t b[8]) {
-	b[0] = (uint8_t)(u >>  0);
-	b[1] = (uint8_t)(u >>  8);
-	b[2] = (uint8_t)(u >> 16);
-	b[3] = (uint8_t)(u >> 24);
-	b[4] = (uint8_t)(u >> 32);
-	b[5] = (uint8_t)(u >> 40);
-	b[6] = (uint8_t)(u >> 48);
-	b[7] = (uint8_t)(u >> 56);
-}
-
 static inline uint512_t uint512frombytes(uint8_t const b[64]) {
-	uint512_t u = {{
-		uint64frombytes(&b[ 0]),
-		uint64frombytes(&b[ 8]),
-		uint64frombytes(&b[16]),
-		uint64frombytes(&b[24]),
-		uint64frombytes(&b[32]),
-		uint64frombytes(&b[40]),
-		uint64frombytes(&b[48]),
-		uint64frombytes(&b[56]),
-	}};
+	uint512_t u;
+	ldu64le_array(b, u.u, 8);
 	return u;
 }
 
 static inline void uint512tobytes(uint512_t u, uint8_t b[64]) {
-	uint64tobytes(u.u[0], &b[ 0]);
-	uint64tobytes(u.u[1], &b[ 8]);
-	uint64tobytes(u.u[2], &b[16]);
-	uint64tobytes(u.u[3], &b[24]);
-	uint64tobytes(u.u[4], &b[32]);
-	uint64tobytes(u.u[5], &b[40]);
-	uint64tobytes(u.u[6], &b[48]);
-	uint64tobytes(u.u[7], &b[56]);
+	stu64le_array(u.u, b, 8);
 }
 
+// the random words only salt and pad the plain text inside each encoded block,
+// and decoding never regenerates them, so how they are drawn is not part of
+// the format; nlis512 keyed with k runs over the counter c, and like any
+// counter mode generator all 8 words of each output block are used, as they
+// are no more related to each other than to the words of any other block
 struct genrand {
 	uint512_t k, c;
+	uint512_t r;
+	size_t    i;
 };
+#define GENRAND_SEED_SIZE  (offsetof(struct genrand, r))
 static uint64_t genrand(void *ctx) {
 	struct genrand *g = ctx;
-	size_t          i = g->k.u[0] % 8;
-	uint512_t       r = nlis512(g->c, g->k, 3*ROUNDS);
-	g->c              = inc512(g->c, 1);
-	return r.u[i];
+	if(g->i >= 8) {
+		g->r = nlis512(g->c, g->k, 3*ROUNDS);
+		g->c = inc512(g->c, 1);
+		g->i = 0;
+	}
+	return g->r.u[g->i++];
 }
 
-static bool encode(size_t z, uint8_t b[z], uint512_t k, XFILE *in, XFILE *out) {
-	bool           ok = false;
+struct coder {
+	XFILE         *in;
+	XFILE         *out;
+	uint512_t      k;
 	struct genrand g;
-	ssize_t        m = getrandom(&g, sizeof(g), 0);
-	if(m != sizeof(g)) {
-		if(m < 0) m = 0;
-		fallback_getrandom((uint8_t*)&g + m, sizeof(g) - m, 0);
-	}
-	uint8_t v[8];
-	uint8_t w[64];
-	z = ((z - 56) / 56) * 56;
-	for(bool eof = false; !eof;) {
-		size_t n = xfread(b, sizeof(*b), z, in);
-		if(n < z) {
-			if(xferror(in)) {
+	uint8_t        d[56];
+	bool           buffered;
+};
+
+static size_t read_block(void *ctx, void *b, size_t z) {
+	struct coder *c = ctx;
+	size_t n = xfread(b, 1, z, c->in);
+	if(n < z) {
+		if(xferror(c->in)) {
 #ifdef EPIPE
-				if(errno != EPIPE)
+			if(errno != EPIPE)
 #endif
-				{
-					goto done;
-				}
+			{
+				return SIZE_MAX;
 			}
-			size_t m = 56 - (n % 56);
-			fillrandom(genrand, &g, &b[n], m);
-			m += n;
-			for(b[n++] |= 0x80; n < m; b[n++] &= 0x7F)
-				;
-			eof = true;
 		}
-		for(size_t m = 0; m < n; m += 56) {
-			uint64_t r = genrand(&g);
-			uint64tobytes(r, &v[0]);
-			size_t  h = 0, i = 0, j = m;
-			uint8_t t = v[h++];
+	}
+	return n;
+}
+
+static bool write_block(void *ctx, void *b, size_t n) {
+	struct coder *c = ctx;
+	return xfwrite(b, 1, n, c->out) == n;
+}
+
+static size_t encode_block(void *ctx, void *out, void *in, size_t n, bool last) {
+	struct coder *c = ctx;
+	uint8_t      *b = in, *o = out;
+	uint8_t       v[8];
+	uint8_t       w[64];
+	if(last) {
+		size_t m = 56 - (n % 56);
+		fillrandom(genrand, &c->g, &b[n], m);
+		m += n;
+		for(b[n++] |= 0x80; n < m; b[n++] &= 0x7F)
+			;
+	}
+	for(size_t m = 0; m < n; m += 56, o += 64) {
+		uint64_t r = genrand(&c->g);
+		stu64le_array(&r, v, 1);
+		size_t  h = 0, i = 0, j = m;
+		uint8_t t = v[h++];
+		w[i++] = t;
+		do {
+			size_t x = t % 8, y = 0;
+			for(; y < x; y++) {
+				w[i++] = b[j++];
+			}
+			t = v[h++];
 			w[i++] = t;
-			do {
-				size_t x = t % 8, y = 0;
-				for(; y < x; y++) {
-					w[i++] = b[j++];
-				}
-				t = v[h++];
-				w[i++] = t;
-				for(; y < 8; y++) {
-					w[i++] = b[j++];
-				}
-			} while(i < 64)
-				;
-			uint512_t u = nlis512(uint512frombytes(w), k, ROUNDS);
-			uint512tobytes(u, w);
-			if(xfwrite(w, 1, 64, out) != 64) {
-				goto done;
+			for(; y < 8; y++) {
+				w[i++] = b[j++];
 			}
-		}
+		} while(i < 64)
+			;
+		uint512_t u = nlis512(uint512frombytes(w), c->k, ROUNDS);
+		uint512tobytes(u, o);
 	}
-	ok = true;
-done:
-	memzero(&k, sizeof(k));
 	memzero(&w, sizeof(w));
 	memzero(&v, sizeof(v));
-	memzero(&g, sizeof(g));
-	return ok;
+	return (n / 56) * 64;
 }
 
-static bool decode(size_t z, uint8_t b[z], uint512_t k, XFILE *in, XFILE *out) {
-	bool    ok = false;
-	uint8_t w[64];
-	uint8_t v[56];
-	uint8_t d[56];
-	z = (z / 64) * 64;
-	for(bool buffered = false, eof = false; !eof;) {
-		size_t n = xfread(b, sizeof(*b), z, in);
-		if(n % 64) {
-			errno = EILSEQ;
-			goto done;
-		}
-		if(n < z) {
-			if(xferror(in)) {
-#ifdef EPIPE
-				if(errno != EPIPE)
-#endif
-				{
-					goto done;
-				}
-			}
-			eof = true;
-		}
-		for(size_t m = 0; m < n; m += 64) {
-			uint512_t u = ulis512(uint512frombytes(&b[m]), k, ROUNDS);
-			uint512tobytes(u, &w[0]);
-			size_t  i = 0, j = 0;
-			uint8_t t = w[j++];
-			do {
-				size_t x = t % 8, y = 0;
-				for(; y < x; y++) {
-					v[i++] = w[j++];
-				}
-				t = w[j++];
-				for(; y < 8; y++) {
-					v[i++] = w[j++];
-				}
-			} while(i < 56)
-				;
-			if(!buffered) {
-				buffered = true;
-			} else {
-				if(xfwrite(d, 1, 56, out) != 56) {
-					goto done;
-				}
-			}
-			memcpy(d, &v[0], 56);
+static size_t decode_block(void *ctx, void *out, void *in, size_t n, bool last) {
+	struct coder *c = ctx;
+	uint8_t      *b = in, *o = out;
+	uint8_t       w[64];
+	if(n % 64) {
+		errno = EILSEQ;
+		return SIZE_MAX;
+	}
+	for(size_t m = 0; m < n; m += 64) {
+		uint512_t u = ulis512(uint512frombytes(&b[m]), c->k, ROUNDS);
+		uint512tobytes(u, &w[0]);
+		if(c->buffered) {
+			memcpy(o, c->d, 56);
+			o += 56;
 		}
-		if(eof && (n > 0)) {
-			for(n = 55; (n > 0) && !(d[n] & 0x80); n--)
-				;
-			if(!(d[n] & 0x80)) {
-				errno = EILSEQ;
-				goto done;
+		c->buffered = true;
+		size_t  i = 0, j = 0;
+		uint8_t t = w[j++];
+		do {
+			size_t x = t % 8, y = 0;
+			for(; y < x; y++) {
+				c->d[i++] = w[j++];
 			}
-			if(xfwrite(d, 1, n, out) != n) {
-				goto done;
+			t = w[j++];
+			for(; y < 8; y++) {
+				c->d[i++] = w[j++];
 			}
+		} while(i < 56)
+			;
+	}
+	memzero(&w, sizeof(w));
+	if(last && c->buffered) {
+		for(n = 55; (n > 0) && !(c->d[n] & 0x80); n--)
+			;
+		if(!(c->d[n] & 0x80)) {
+			errno = EILSEQ;
+			return SIZE_MAX;
 		}
+		memcpy(o, c->d, n);
+		o += n;
+	}
+	return o - (uint8_t *)out;
+}
+
+static bool encode(size_t z, uint512_t k, XFILE *in, XFILE *out) {
+	struct coder c = { .in = in, .out = out, .k = k, .g = { .i = 8 } };
+	ssize_t      m = getrandom(&c.g, GENRAND_SEED_SIZE, 0);
+	if(m != GENRAND_SEED_SIZE) {
+		if(m < 0) m = 0;
+		fallback_getrandom((uint8_t*)&c.g + m, GENRAND_SEED_SIZE - m, 0);
 	}
-	ok = true;
-done:
+	// the last block is padded in place, up to the next whole 56 bytes
+	z = ((z - 56) / 56) * 56;
+	struct pipeline p = {
+		.in_size   = z,
+		.out_size  = (z / 56) * 64,
+		.depth     = PIPELINE_DEPTH,
+		.clear     = true,
+		.read      = read_block,
+		.transform = encode_block,
+		.write     = write_block,
+		.ctx       = &c,
+	};
+	int rc = pipeline_run(&p);
 	memzero(&k, sizeof(k));
-	memzero(&w, sizeof(w));
-	memzero(&v, sizeof(v));
-	memzero(&d, sizeof(d));
-	return ok;
+	memzero(&c, sizeof(c));
+	return rc == 0;
+}
+
+static bool decode(size_t z, uint512_t k, XFILE *in, XFILE *out) {
+	struct coder c = { .in = in, .out = out, .k = k };
+	// the 56 bytes held back from one block go out with the next
+	z = (z / 64) * 64;
+	struct pipeline p = {
+		.in_size   = z,
+		.out_size  = (z / 64) * 56,
+		.depth     = PIPELINE_DEPTH,
+		.clear     = true,
+		.read      = read_block,
+		.transform = decode_block,
+		.write     = write_block,
+		.ctx       = &c,
+	};
+	int rc = pipeline_run(&p);
+	memzero(&k, sizeof(k));
+	memzero(&c, sizeof(c));
+	return rc == 0;
 }
 
 static uint512_t initialize(uint512_t k, void const *key, size_t z) {
@@ -318,7 +321,7 @@ main(
 	}
 
 	uint512_t k = nlis512((uint512_t){{1}}, (uint512_t){{0}}, ROUNDS);
-	bool    (*coder)(size_t z, uint8_t b[z], uint512_t k, XFILE *in, XFILE *out) = 0;
+	bool    (*coder)(size_t z, uint512_t k, XFILE *in, XFILE *out) = 0;
 	int       keytype = 0;
 	size_t    keylen = 0;
 	char     *key = NULL;
@@ -398,14 +401,7 @@ main(
 		fail();
 	}
 
-	size_t   const z = BUFSIZ * 64;
-	uint8_t *const b = calloc(z, sizeof(*b));
-	if(!b) {
-		perror();
-		memzero((void *)key, keylen);
-		xfclose(out);
-		fail();
-	}
+	size_t const z = BUFSIZ * 64;
 	if(keytype < 2) {
 		size_t n = base64declen(keylen);
 		char  *s = calloc(n, sizeof(*s));
@@ -451,16 +447,14 @@ main(
 				if(errno == EPERM) continue;
 #endif
 				perror(args);
-				memzero(b, z * sizeof(*b));
 				memzero(&k, sizeof(k));
 				xfclose(out);
 				fail();
 			}
 		}
-		if(!coder(z, b, k, in, out)) {
+		if(!coder(z, k, in, out)) {
 			if(xferror(out)) perror(xfname(out));
 			else             perror(xfname(in));
-			memzero(b, z * sizeof(*b));
 			memzero(&k, sizeof(k));
 			xfclose(out);
 			xfclose(in);
@@ -468,7 +462,6 @@ main(
 		}
 	} while(argi < argc)
 		;
-	memzero(b, z * sizeof(*b));
 	memzero(&k, sizeof(k));
 	xfclose(out);
 	xfclose(in);
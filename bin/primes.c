@@ -25,6 +25,7 @@ SOFTWARE.
 //------------------------------------------------------------------------------
 
 #include <hol/holibc.h>
+#include <pthread.h>
 
 //------------------------------------------------------------------------------
 
@@ -60,9 +61,691 @@ sqrtumax(
 
 //------------------------------------------------------------------------------
 
-static FILE *outf = NULL;
+// Mod 30 wheel: of every 30 values only the 8 coprime to 30 can be prime,
+// other than 2, 3 and 5; stepping through the gaps between them skips the
+// multiples of 2, 3 and 5.
 
-static struct array primes = ARRAY();
+static uint8_t const wheel_primes [3] = { 2, 3, 5 };
+static uint8_t const wheel_residue[8] = { 1, 7, 11, 13, 17, 19, 23, 29 };
+static uint8_t const wheel_gap    [8] = { 6, 4,  2,  4,  2,  4,  6,  2 };
+
+// index of the residue at or next above each value mod 30
+static uint8_t const wheel_index[30] = {
+	0, 0, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 4,
+	4, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7
+};
+
+// for p = 30a + wheel_residue[c] and q on the wheel at index i: the index
+// of the residue of p*q, and the carry into the multiple of 30 when stepping
+// to p*(q + wheel_gap[i]), which is then 30(a * wheel_gap[i] + carry) on
+static uint8_t const wheel_bit[8][8] = {
+	{ 0, 1, 2, 3, 4, 5, 6, 7 },
+	{ 1, 5, 4, 0, 7, 3, 2, 6 },
+	{ 2, 4, 0, 6, 1, 7, 3, 5 },
+	{ 3, 0, 6, 5, 2, 1, 7, 4 },
+	{ 4, 7, 1, 2, 5, 6, 0, 3 },
+	{ 5, 3, 7, 1, 6, 0, 4, 2 },
+	{ 6, 2, 3, 7, 0, 4, 5, 1 },
+	{ 7, 6, 5, 4, 3, 2, 1, 0 },
+};
+static uint8_t const wheel_carry[8][8] = {
+	{ 0, 0, 0, 0, 0, 0, 0, 1 },
+	{ 1, 1, 1, 0, 1, 1, 1, 1 },
+	{ 2, 2, 0, 2, 0, 2, 2, 1 },
+	{ 3, 1, 1, 2, 1, 1, 3, 1 },
+	{ 3, 3, 1, 2, 1, 3, 3, 1 },
+	{ 4, 2, 2, 2, 2, 2, 4, 1 },
+	{ 5, 3, 1, 4, 1, 3, 5, 1 },
+	{ 6, 4, 2, 4, 2, 4, 6, 1 },
+};
+
+static inline uintmax_t
+wheel_step(
+	uintmax_t  v,
+	unsigned  *ip
+) {
+	unsigned const i = *ip;
+	*ip = (i + 1) % 8;
+	return v + wheel_gap[i];
+}
+
+//------------------------------------------------------------------------------
+
+// Deterministic Miller-Rabin for 64-bit values, with the arithmetic done in
+// Montgomery form: R = 2^64, and values are held as aR mod n.
+
+struct mont {
+	uint64_t n;
+	uint64_t inv;
+	uint64_t one;
+	uint64_t r2;
+};
+
+static inline uint64_t
+mont__mul(
+	uint64_t  a,
+	uint64_t  b,
+	uint64_t *lo
+) {
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 const t = (unsigned __int128)a * b;
+	*lo = (uint64_t)t;
+	return (uint64_t)(t >> 64);
+#else
+	uintmax_t h, l;
+	uumulu(0, a, b, &h, &l);
+	*lo = l;
+	return h;
+#endif
+}
+
+static inline void
+mont_init(
+	struct mont *m,
+	uint64_t     n
+) {
+	// n is odd; Newton's iteration doubles the correct low bits of n^-1
+	uint64_t inv = n;
+	for(int i = 0; i < 5; i++) {
+		inv *= 2 - (n * inv);
+	}
+	uint64_t one = (0 - n) % n;
+	uint64_t r2  = one;
+	for(int i = 0; i < 64; i++) {
+		r2 = (r2 >= (n - r2)) ? (r2 - (n - r2)) : (r2 + r2);
+	}
+	m->n   = n;
+	m->inv = inv;
+	m->one = one;
+	m->r2  = r2;
+}
+
+static inline uint64_t
+mont_mul(
+	struct mont const *m,
+	uint64_t           a,
+	uint64_t           b
+) {
+	uint64_t       lo, ql;
+	uint64_t const hi = mont__mul(a, b, &lo);
+	uint64_t const qh = mont__mul(lo * m->inv, m->n, &ql);
+	return (hi >= qh) ? (hi - qh) : (hi - qh + m->n);
+}
+
+static bool
+mont__witness(
+	struct mont const *m,
+	uint64_t           a,
+	uint64_t           d,
+	int                s
+) {
+	// true when a proves n composite
+	uint64_t const minus_one = m->n - m->one;
+	uint64_t       b = mont_mul(m, a % m->n, m->r2);
+	uint64_t       x = m->one;
+	for(; d; d >>= 1) {
+		if(d & 1) x = mont_mul(m, x, b);
+		b = mont_mul(m, b, b);
+	}
+	if((x == m->one) || (x == minus_one)) return false;
+	while(--s > 0) {
+		x = mont_mul(m, x, x);
+		if(x == minus_one) return false;
+	}
+	return true;
+}
+
+static bool
+is_prime__miller_rabin(
+	uintmax_t v
+) {
+	static uint8_t  const small[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+	// these bases are sufficient for all values below 2^64
+	static uint64_t const bases[] = { 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };
+
+	if(v < 2) return false;
+	for(size_t i = 0; i < sizeof(small); i++) {
+		if(v == small[i]) return true;
+		if((v % small[i]) == 0) return false;
+	}
+	if(v < (37 * 37)) return true;
+
+	struct mont m;
+	mont_init(&m, v);
+	uint64_t d = v - 1;
+	int      s = tzcount(d);
+	d >>= s;
+	for(size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+		if((bases[i] % v) == 0) continue;
+		if(mont__witness(&m, bases[i], d, s)) return false;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+
+// Segmented sieve of Eratosthenes on the mod 30 wheel: byte k of a segment
+// holds the 8 bits for lo + 30k + wheel_residue[], and a bit is cleared when
+// its value is composite. Segments are sized to stay in the L1 cache; the
+// base primes used for sieving are pulled in, as segments advance, from a
+// second sieve over [7, 2^32), which is itself sieved by a small pre-loaded
+// table of base primes.
+
+enum {
+	SIEVE_SEGMENT_BYTES = 32 * 1024,
+	SIEVE_SEGMENT_WORDS = SIEVE_SEGMENT_BYTES / sizeof(uint64_t),
+	SIEVE_SEGMENT_SPAN  = SIEVE_SEGMENT_BYTES * 30,
+	SIEVE_SMALL_LIMIT   = 65535
+};
+
+struct sieve_base {
+	uint32_t  p;
+	uint32_t  i;
+	uintmax_t o;
+};
+
+struct sieve {
+	uintmax_t          lo;
+	uintmax_t          min;
+	uintmax_t          hi;
+	size_t             n;
+	size_t             i;
+	bool               end;
+	uint64_t          *bits;
+	size_t             n_base;
+	size_t             n_active;
+	size_t             z_base;
+	struct sieve_base *base;
+	struct sieve      *src;
+};
+
+static bool
+sieve__add_base(
+	struct sieve *s,
+	uint32_t      p
+) {
+	if(s->n_base == s->z_base) {
+		size_t const z = (s->z_base + 1) + (s->z_base >> 1);
+		void  *const b = realloc(s->base, z * sizeof(*s->base));
+		if(unlikely(!b)) return false;
+		s->base   = b;
+		s->z_base = z;
+	}
+	s->base[s->n_base++].p = p;
+	return true;
+}
+
+static bool
+sieve__small(
+	struct sieve *s
+) {
+	static uint8_t composite[SIEVE_SMALL_LIMIT + 1];
+	for(uint32_t p = 3; p <= SIEVE_SMALL_LIMIT; p += 2) {
+		if(!composite[p]) {
+			if((p > 5) && unlikely(!sieve__add_base(s, p))) return false;
+			for(uint32_t m = p * p; m <= SIEVE_SMALL_LIMIT; m += 2 * p) {
+				composite[m] = 1;
+			}
+		}
+	}
+	return true;
+}
+
+static inline uintmax_t
+sieve__offset(
+	uint32_t  p,
+	uintmax_t lo,
+	uint32_t *ip
+) {
+	// byte offset from lo of the first multiple p*q, with q >= p and on the
+	// wheel, at or after lo; and the wheel index of q
+	uintmax_t const pp = (uintmax_t)p * p;
+	if(pp >= lo) {
+		*ip = wheel_index[p % 30];
+		return (pp - lo) / 30;
+	}
+	uintmax_t const r = lo % p;
+	unsigned  const q = (unsigned)(((lo / p) + (r != 0)) % 30);
+	unsigned  const i = wheel_index[q];
+	*ip = i;
+	return ((r ? p - r : 0) + ((uintmax_t)p * (wheel_residue[i] - q))) / 30;
+}
+
+static void
+sieve_clear(
+	struct sieve *s
+) {
+	if(s->src) {
+		sieve_clear(s->src);
+		free(s->src);
+	}
+	free(s->bits);
+	free(s->base);
+	*s = (struct sieve){ .end = true };
+}
+
+static bool
+sieve_init(
+	struct sieve *s,
+	uintmax_t     lo,
+	uintmax_t     hi,
+	uintmax_t     lim
+) {
+	*s = (struct sieve){ .lo = lo - (lo % 30), .min = (lo > 7) ? lo : 7, .hi = hi };
+	s->end  = (s->min > hi);
+	s->bits = malloc(SIEVE_SEGMENT_BYTES);
+	if(unlikely(!s->bits)) goto error_return;
+
+	if(lim > SIEVE_SMALL_LIMIT) {
+		s->src = malloc(sizeof(*s->src));
+		if(unlikely(!s->src)) goto error_return;
+		if(unlikely(!sieve_init(s->src, 7, lim, sqrtumax(lim)))) {
+			free(s->src), s->src = NULL;
+			goto error_return;
+		}
+	} else if(unlikely(!sieve__small(s))) {
+		goto error_return;
+	}
+	return true;
+
+error_return:
+	sieve_clear(s);
+	return false;
+}
+
+static uintmax_t sieve_next(struct sieve *s);
+
+static bool
+sieve__load(
+	struct sieve *s,
+	uintmax_t     lim
+) {
+	// the table is left holding one prime past lim, unless the source ends
+	while(s->src && ((s->n_base == 0) || (s->base[s->n_base - 1].p <= lim))) {
+		uintmax_t const p = sieve_next(s->src);
+		if(!p) {
+			sieve_clear(s->src);
+			free(s->src), s->src = NULL;
+			break;
+		}
+		if(unlikely(!sieve__add_base(s, (uint32_t)p))) return false;
+	}
+	return true;
+}
+
+static bool
+sieve__activate(
+	struct sieve *s,
+	uintmax_t     hi
+) {
+	uintmax_t const lim = sqrtumax(hi);
+	if(unlikely(!sieve__load(s, lim))) return false;
+	for(; (s->n_active < s->n_base) && (s->base[s->n_active].p <= lim); s->n_active++) {
+		struct sieve_base *b = &s->base[s->n_active];
+		b->o = sieve__offset(b->p, s->lo, &b->i);
+	}
+	return true;
+}
+
+static inline void
+sieve__fill(
+	struct sieve const *s,
+	uint64_t           *bits,
+	size_t              n,
+	uintmax_t           lo
+) {
+	size_t const w = (n + 7) / 8;
+	memset(bits, 0xFF, w * sizeof(*bits));
+	if(n % 8) bits[w - 1] = ~(~UINT64_C(0) << (8 * (n % 8)));
+
+	// clear the values outside of the range, at either end
+	uintmax_t const l = lo + (30 * (uintmax_t)(n - 1));
+	for(size_t j = 0; j < 8; j++) {
+		if((s->min > lo) && ((s->min - lo) > wheel_residue[j])) {
+			bits[0] &= ~(UINT64_C(1) << j);
+		}
+		if(wheel_residue[j] > (s->hi - l)) {
+			size_t const g = (8 * (n - 1)) + j;
+			bits[g / 64] &= ~(UINT64_C(1) << (g % 64));
+		}
+	}
+}
+
+static inline void
+sieve__cross(
+	uint64_t          *bits,
+	size_t             n,
+	size_t             k,
+	struct sieve_base *base
+) {
+	// offsets are left relative to the end of the segment
+	for(; k-- > 0; base++) {
+		uintmax_t const p = base->p;
+		uintmax_t const a = p / 30;
+		unsigned  const c = wheel_index[p % 30];
+		uintmax_t       o = base->o;
+		unsigned        i = base->i;
+		if((o + p) <= n) {
+			// a whole turn of the wheel advances p bytes, and crosses off one
+			// bit in each of the same eight byte offsets from the start
+			size_t   t[8];
+			unsigned b[8];
+			size_t   d = 0;
+			for(unsigned j = 0; j < 8; j++) {
+				unsigned const x = (i + j) % 8;
+				t[j] = d;
+				b[j] = wheel_bit[c][x];
+				d   += (a * wheel_gap[x]) + wheel_carry[c][x];
+			}
+			for(; (o + p) <= n; o += p) {
+				for(unsigned j = 0; j < 8; j++) {
+					size_t const g = (8 * (size_t)(o + t[j])) + b[j];
+					bits[g / 64] &= ~(UINT64_C(1) << (g % 64));
+				}
+			}
+		}
+		for(; o < n; o += (a * wheel_gap[i]) + wheel_carry[c][i], i = (i + 1) % 8) {
+			size_t const g = (8 * (size_t)o) + wheel_bit[c][i];
+			bits[g / 64] &= ~(UINT64_C(1) << (g % 64));
+		}
+		base->o = o - n;
+		base->i = i;
+	}
+}
+
+static bool
+sieve_segment(
+	struct sieve *s
+) {
+	if(s->n > 0) {
+		s->lo += 30 * (uintmax_t)(s->n / 8);
+		s->n   = 0;
+	}
+	if(s->end) return false;
+
+	size_t          n  = SIEVE_SEGMENT_BYTES;
+	uintmax_t const hn = (s->hi - s->lo) / 30;
+	if(hn < n) {
+		n = (size_t)hn + 1;
+		s->end = true;
+	}
+	uintmax_t const hi = s->end ? s->hi : (s->lo + (30 * (uintmax_t)n) - 1);
+	if(unlikely(!sieve__activate(s, hi))) {
+		errorf("unable to extend sieving primes");
+		s->end = true;
+		return false;
+	}
+
+	sieve__fill(s, s->bits, n, s->lo);
+	sieve__cross(s->bits, n, s->n_active, s->base);
+
+	s->n = 8 * n;
+	s->i = 0;
+	return true;
+}
+
+static uintmax_t
+sieve_next(
+	struct sieve *s
+) {
+	for(;;) {
+		for(size_t i = s->i; i < s->n; i = (i | 63) + 1) {
+			uint64_t const w = s->bits[i / 64] >> (i % 64);
+			if(w) {
+				i += tzcount(w);
+				s->i = i + 1;
+				return s->lo + (30 * (uintmax_t)(i / 8)) + wheel_residue[i % 8];
+			}
+		}
+		s->i = s->n;
+		if(!sieve_segment(s)) return 0;
+	}
+}
+
+//------------------------------------------------------------------------------
+
+// Threaded sieving: the coordinating thread hands out jobs of consecutive
+// segments from a ring of slots, and emits them in order as they complete;
+// the ring bounds how far the workers can run ahead of the output. Workers
+// only read the base table, which the coordinator extends, after draining
+// the ring, to twice the square root needed; so it is rarely extended.
+
+enum {
+	SIEVE_JOB_SEGMENTS = 8,
+	SIEVE_JOB_BYTES    = SIEVE_JOB_SEGMENTS * SIEVE_SEGMENT_BYTES,
+	SIEVE_JOB_WORDS    = SIEVE_JOB_SEGMENTS * SIEVE_SEGMENT_WORDS,
+	SIEVE_JOBS_PER_THREAD = 4,
+	SIEVE_MAX_THREADS  = 256
+};
+
+struct sieve_job {
+	uintmax_t lo;
+	uintmax_t hi;
+	size_t    n;
+	size_t    n_base;
+	bool      done;
+	uint64_t *bits;
+};
+
+struct sieve_worker {
+	pthread_t          thread;
+	struct sieve_pool *pool;
+	size_t             z_base;
+	struct sieve_base *base;
+};
+
+struct sieve_pool {
+	pthread_mutex_t     lock;
+	pthread_cond_t      work;
+	pthread_cond_t      done;
+	bool                quit;
+	size_t              n_slots;
+	size_t              n_queued;
+	size_t              n_taken;
+	size_t              n_done;
+	struct sieve_job   *slot;
+	struct sieve       *sieve;
+	size_t              n_workers;
+	struct sieve_worker worker[];
+};
+
+static bool
+sieve__job(
+	struct sieve_worker *w,
+	struct sieve_job    *j
+) {
+	// primes below the segment size are crossed off a segment at a time,
+	// larger primes a job at a time, which needs no stored offsets
+	struct sieve      const *s    = w->pool->sieve;
+	struct sieve_base const *base = s->base;
+	uintmax_t const          lim  = sqrtumax(j->hi);
+	size_t                   k    = 0;
+	for(; (k < j->n_base) && (base[k].p <= lim) && (base[k].p < SIEVE_SEGMENT_SPAN); k++) {
+		if(k == w->z_base) {
+			size_t const z = (w->z_base + 1) + (w->z_base >> 1);
+			void  *const b = realloc(w->base, z * sizeof(*w->base));
+			if(unlikely(!b)) return false;
+			w->base   = b;
+			w->z_base = z;
+		}
+		w->base[k].p = base[k].p;
+		w->base[k].o = sieve__offset(base[k].p, j->lo, &w->base[k].i);
+	}
+
+	sieve__fill(s, j->bits, j->n, j->lo);
+	for(size_t i = 0; i < j->n; i += SIEVE_SEGMENT_BYTES) {
+		size_t const n = ((j->n - i) < SIEVE_SEGMENT_BYTES) ? (j->n - i) : SIEVE_SEGMENT_BYTES;
+		sieve__cross(j->bits + (i / 8), n, k, w->base);
+	}
+	for(; (k < j->n_base) && (base[k].p <= lim); k++) {
+		struct sieve_base b = { .p = base[k].p };
+		b.o = sieve__offset(b.p, j->lo, &b.i);
+		sieve__cross(j->bits, j->n, 1, &b);
+	}
+	return true;
+}
+
+static void *
+sieve__worker(
+	void *arg
+) {
+	struct sieve_worker *w = arg;
+	struct sieve_pool   *t = w->pool;
+
+	pthread_mutex_lock(&t->lock);
+	for(;;) {
+		while(!t->quit && (t->n_taken == t->n_queued)) {
+			pthread_cond_wait(&t->work, &t->lock);
+		}
+		if(t->quit) break;
+
+		struct sieve_job *j = &t->slot[t->n_taken++ % t->n_slots];
+		pthread_mutex_unlock(&t->lock);
+
+		bool const ok = sieve__job(w, j);
+
+		pthread_mutex_lock(&t->lock);
+		if(unlikely(!ok)) {
+			errorf("unable to allocate sieving primes");
+			t->quit = true;
+			pthread_cond_broadcast(&t->done);
+			break;
+		}
+		j->done = true;
+		t->n_done++;
+		pthread_cond_signal(&t->done);
+	}
+	pthread_mutex_unlock(&t->lock);
+
+	return NULL;
+}
+
+static void
+del_sieve_pool(
+	struct sieve_pool *t
+) {
+	if(t) {
+		pthread_mutex_lock(&t->lock);
+		t->quit = true;
+		pthread_cond_broadcast(&t->work);
+		pthread_mutex_unlock(&t->lock);
+		for(size_t i = 0; i < t->n_workers; i++) {
+			pthread_join(t->worker[i].thread, NULL);
+			free(t->worker[i].base);
+		}
+		for(size_t i = 0; i < t->n_slots; i++) {
+			free(t->slot[i].bits);
+		}
+		free(t->slot);
+		pthread_cond_destroy(&t->done);
+		pthread_cond_destroy(&t->work);
+		pthread_mutex_destroy(&t->lock);
+		free(t);
+	}
+}
+
+static struct sieve_pool *
+new_sieve_pool(
+	struct sieve *s,
+	size_t        n_threads
+) {
+	struct sieve_pool *t = calloc(1, sizeof(*t) + (n_threads * sizeof(t->worker[0])));
+	if(unlikely(!t)) return NULL;
+
+	pthread_mutex_init(&t->lock, NULL);
+	pthread_cond_init(&t->work, NULL);
+	pthread_cond_init(&t->done, NULL);
+	t->sieve   = s;
+	t->n_slots = n_threads * SIEVE_JOBS_PER_THREAD;
+	t->slot    = calloc(t->n_slots, sizeof(*t->slot));
+	if(unlikely(!t->slot)) goto error_return;
+	for(size_t i = 0; i < t->n_slots; i++) {
+		t->slot[i].bits = malloc(SIEVE_JOB_WORDS * sizeof(uint64_t));
+		if(unlikely(!t->slot[i].bits)) goto error_return;
+	}
+	for(; t->n_workers < n_threads; t->n_workers++) {
+		struct sieve_worker *w = &t->worker[t->n_workers];
+		w->pool = t;
+		if(pthread_create(&w->thread, NULL, sieve__worker, w) != 0) goto error_return;
+	}
+	return t;
+
+error_return:
+	del_sieve_pool(t);
+	return NULL;
+}
+
+static bool
+sieve_pool_queue(
+	struct sieve_pool *t
+) {
+	// called with the lock held, when there is a free slot
+	struct sieve *s = t->sieve;
+	if(s->end || t->quit) return false;
+
+	size_t          n  = SIEVE_JOB_BYTES;
+	uintmax_t const hn = (s->hi - s->lo) / 30;
+	if(hn < n) {
+		n = (size_t)hn + 1;
+		s->end = true;
+	}
+	uintmax_t const hi  = s->end ? s->hi : (s->lo + (30 * (uintmax_t)n) - 1);
+	uintmax_t const lim = sqrtumax(hi);
+	if(s->src && ((s->n_base == 0) || (s->base[s->n_base - 1].p <= lim))) {
+		while(!t->quit && (t->n_done < t->n_queued)) {
+			pthread_cond_wait(&t->done, &t->lock);
+		}
+		if(t->quit) return false;
+		if(unlikely(!sieve__load(s, 2 * lim))) {
+			errorf("unable to extend sieving primes");
+			t->quit = true;
+			return false;
+		}
+	}
+
+	struct sieve_job *j = &t->slot[t->n_queued % t->n_slots];
+	j->lo     = s->lo;
+	j->hi     = hi;
+	j->n      = n;
+	j->n_base = s->n_base;
+	j->done   = false;
+	if(!s->end) s->lo = hi + 1;
+
+	t->n_queued++;
+	pthread_cond_signal(&t->work);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+
+static FILE         *outf = NULL;
+static struct fmtbuf outb;
+
+static inline bool
+print_value(
+	uintmax_t v,
+	bool      as_hex
+) {
+	as_hex ? fmtbuf_u64hex(&outb, v) : fmtbuf_u64dec(&outb, v);
+	fmtbuf_putc(&outb, '\n');
+	return !outb.error;
+}
+
+static bool
+flush_output(
+	void
+) {
+	if(unlikely((fmtbuf_flush(&outb) != 0) || (fflush(outb.out) != 0))) {
+		errorf("unable to write to output");
+		return false;
+	}
+	return true;
+}
+
+// trial division only keeps the base primes, which are at most 2^32
+static struct array primes       = ARRAY();
+static uintmax_t    primes_limit = 0;
+static size_t       primes_found = 0;
 
 static const char index_suffix[][3] = {
 	/* 0 */ "th",
@@ -85,9 +768,14 @@ add_prime(
 ) {
 	bool status = true;
 
-	uintmax_t *const p = array_push(uintmax_t, &primes);
+	primes_found++;
+	if(v > primes_limit) {
+		return status;
+	}
+
+	uint32_t *const p = array_push(uint32_t, &primes);
 	if(likely(p)) {
-		*p = v;
+		*p = (uint32_t)v;
 
 	} else {
 		size_t      const i  = primes.len;
@@ -105,7 +793,10 @@ is_prime__foreach(
 ) {
 	uintmax_t lim = sqrtumax(v);
 
-	FOREACH(uintmax_t, p, &primes,
+	// primes is reserved ahead, so stop at its length, not its capacity
+	size_t n = primes.len;
+	FOREACH(uint32_t, p, &primes,
+		if(n-- == 0) return true;
 		uintmax_t const u = *p;
 		if(u > lim) return true;
 
@@ -122,8 +813,9 @@ is_prime__for(
 ) {
 	uintmax_t const lim = sqrtumax(v);
 
-	for(size_t i = 1; i < primes.len; ++i) {
-		uintmax_t const u = *array_at(uintmax_t, &primes, i);
+	// candidates are on the wheel, so skip 2, 3 and 5
+	for(size_t i = 3; i < primes.len; ++i) {
+		uintmax_t const u = *array_at(uint32_t, &primes, i);
 		if(u > lim) return true;
 
 		uintmax_t const m = (v % u);
@@ -135,30 +827,11 @@ is_prime__for(
 
 //------------------------------------------------------------------------------
 
-static int
-process (
-	bool    (*const is_prime)(
-		uintmax_t v
-	),
-	uintmax_t const range_min,
-	uintmax_t const range_max,
+static uintmax_t
+end_digits_of(
 	uintmax_t const ends_with,
-	size_t          n_primes,
-	bool      const as_hex,
-	int       const timed,
-	bool      const list
+	bool      const as_hex
 ) {
-	bool status = (n_primes < SIZE_MAX) ? (
-		array_reserve(uintmax_t, &primes, n_primes)
-	):(
-		array_reserve(uintmax_t, &primes, SIZE_BIT)
-	);
-	if(!status) {
-		return status;
-	}
-
-	char const* const fmt = as_hex ? "%"PRIxMAX"\n" : "%"PRIuMAX"\n";
-
 	uintmax_t v = 0;
 
 	if(as_hex) {
@@ -178,7 +851,732 @@ process (
 		}
 	}
 
-	uintmax_t const end_digits = v;
+	return v;
+}
+
+static void
+print_time_per_prime(
+	int                    timed,
+	struct timespec const *t1,
+	size_t                 n_found
+) {
+	flush_output();
+	struct timespec t2;
+	timestamp(timed, &t2);
+	time_interval(t1, &t2, &t2);
+	struct timespec t3 = t2;
+	time_per(&t2, n_found, &t3);
+	print_time_interval(t2.tv_sec, t2.tv_nsec);
+	putstr(" = ");
+	print_time_interval(t3.tv_sec, t3.tv_nsec);
+	puts(" per prime");
+}
+
+//------------------------------------------------------------------------------
+
+struct emitter {
+	bool        as_hex;
+	uintmax_t   min;
+	uintmax_t   max;
+	uintmax_t   sq;
+	uintmax_t   ends_with;
+	uintmax_t   end_digits;
+	size_t      n_primes;
+	size_t      n_found;
+	bool        list;
+};
+
+static void
+emitter_init(
+	struct emitter *e,
+	uintmax_t const range_min,
+	uintmax_t const range_max,
+	uintmax_t const ends_with,
+	size_t    const n_primes,
+	bool      const as_hex,
+	bool      const list
+) {
+	e->as_hex     = as_hex;
+	e->min        = range_min;
+	e->max        = range_max;
+	e->sq         = UINTMAX_MAX;
+	e->ends_with  = ends_with;
+	e->end_digits = end_digits_of(ends_with, as_hex);
+	e->n_primes   = n_primes;
+	e->n_found    = 0;
+	e->list       = list;
+}
+
+static inline bool
+emit_prime(
+	struct emitter *e,
+	uintmax_t       v
+) {
+	e->n_found++;
+
+	if(e->end_digits > 0) {
+		uintmax_t const ending = v % e->end_digits;
+		if(ending != e->ends_with) {
+			return true;
+		}
+	}
+
+	if(e->list && unlikely(!print_value(v, e->as_hex))) {
+		errorf("unable to write to output");
+		return false;
+	}
+
+	--e->n_primes;
+	return true;
+}
+
+static bool
+emit_wheel_primes(
+	struct emitter *e
+) {
+	for(size_t k = 0; (e->n_primes > 0) && (k < sizeof(wheel_primes)); k++) {
+		uintmax_t const v = wheel_primes[k];
+		if((v < e->min) || (v > e->max)) {
+			continue;
+		}
+		if(unlikely(!emit_prime(e, v))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// emits the primes of a mod 30 bitmap, with n bits, starting at lo;
+// survivors above e->sq are only pre-sieved, and are tested directly
+static bool
+emit_bits(
+	struct emitter *e,
+	uintmax_t       lo,
+	uint64_t const *bits,
+	size_t          n
+) {
+	for(size_t i = 0; (e->n_primes > 0) && (i < n); i += 64) {
+		for(uint64_t w = bits[i / 64]; (e->n_primes > 0) && w; w &= w - 1) {
+			size_t    const g = i + tzcount(w);
+			uintmax_t const v = lo + (30 * (uintmax_t)(g / 8)) + wheel_residue[g % 8];
+			if((v < e->min) || (v > e->max)) {
+				continue;
+			}
+			if((v > e->sq) && !is_prime__miller_rabin(v)) {
+				continue;
+			}
+			if(unlikely(!emit_prime(e, v))) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+
+// Prime cache: a sieved range kept as its mod 30 bitmap, one byte per 30
+// values, after a header of the magic, then MIN and MAX of the range as
+// little-endian 64 bit values. Byte k holds the bits for lo + 30k +
+// wheel_residue[], with lo being MIN rounded down to a multiple of 30; and
+// 2, 3 and 5 are implied. The file may stop short of MAX, when fewer primes
+// were asked for, so the values covered are those of the bytes present.
+
+#define PRIME_CACHE_MAGIC  "PRIMES\0\1"
+
+enum {
+	PRIME_CACHE_HEADER = 24
+};
+
+static char const *cache_file = NULL;
+static uint8_t    *cache      = NULL;
+static size_t      cache_size = 0;
+
+static FILE *
+prime_cache_create(
+	char const *file,
+	uintmax_t   min,
+	uintmax_t   max
+) {
+	FILE *f = fopen(file, "wb");
+	if(unlikely(!f)) {
+		errorf("unable to open prime cache: %s", file);
+		return NULL;
+	}
+
+	uint8_t h[PRIME_CACHE_HEADER];
+	memcpy(h, PRIME_CACHE_MAGIC, 8);
+	setu64le((uint64_t)min, h + 8);
+	setu64le((uint64_t)max, h + 16);
+	if(unlikely(fwrite(h, 1, sizeof(h), f) != sizeof(h))) {
+		errorf("unable to write prime cache: %s", file);
+		fclose(f);
+		return NULL;
+	}
+
+	return f;
+}
+
+static bool
+prime_cache_write(
+	FILE           *f,
+	uint64_t const *bits,
+	size_t          n
+) {
+#if LEBE_BIG_ENDIAN_BYTE_ORDER
+	for(size_t i = 0; i < n; i += sizeof(uint64_t)) {
+		uint64_t     w;
+		size_t const z = ((n - i) < sizeof(w)) ? (n - i) : sizeof(w);
+		setu64le(bits[i / sizeof(w)], &w);
+		if(unlikely(fwrite(&w, 1, z, f) != z)) {
+			break;
+		}
+	}
+	if(!ferror(f)) return true;
+#else
+	if(fwrite(bits, 1, n, f) == n) return true;
+#endif
+	errorf("unable to write prime cache: %s", cache_file);
+	return false;
+}
+
+static bool
+prime_cache_load(
+	char const *file
+) {
+	if(cache) {
+		unmapfile(cache, cache_size);
+		cache = NULL;
+	}
+
+	cache = mapfile(file, &cache_size);
+	if(unlikely(!cache)) {
+		errorf("unable to open prime cache: %s", file);
+		return false;
+	}
+
+	if((cache_size < PRIME_CACHE_HEADER)
+		|| (memcmp(cache, PRIME_CACHE_MAGIC, 8) != 0)
+		|| (getu64le(cache + 8) > getu64le(cache + 16))
+	) {
+		errorf("invalid prime cache: %s", file);
+		unmapfile(cache, cache_size);
+		cache = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+static int
+process_cache(
+	uintmax_t const range_min,
+	uintmax_t const range_max,
+	uintmax_t const ends_with,
+	size_t    const n_primes,
+	bool      const as_hex,
+	int       const timed,
+	bool      const list
+) {
+	uintmax_t const c_min = getu64le(cache + 8);
+	uintmax_t const c_max = getu64le(cache + 16);
+	uintmax_t const lo    = c_min - (c_min % 30);
+	size_t    const n     = cache_size - PRIME_CACHE_HEADER;
+
+	// an unbounded range lists what is cached, from its minimum when no range
+	// was given, but a bounded one must fit
+	uintmax_t const min = ((range_min == 0) && (range_max == UINTMAX_MAX)) ? c_min : range_min;
+	uintmax_t       max = (range_max < c_max) ? range_max : c_max;
+	if((n > 0) && (((max - lo) / 30) >= n)) {
+		max = lo + (30 * (uintmax_t)n) - 1;
+	}
+	if((min < c_min)
+		|| ((range_max != UINTMAX_MAX) && ((n == 0) || (range_max > max)))
+	) {
+		errorf("range not covered by prime cache");
+		return false;
+	}
+
+	struct timespec t1;
+	timestamp(timed, &t1);
+
+	struct emitter e;
+	emitter_init(&e, min, max, ends_with, n_primes, as_hex, list);
+
+	bool status = emit_wheel_primes(&e);
+
+	if(n > 0) {
+		// words are read aligned, the mapping being page aligned
+		size_t const k1 = (size_t)((max - lo) / 30) + 1;
+		size_t       k  = (size_t)((min - lo) / 30) & ~(size_t)7;
+		for(uint64_t bits[SIEVE_SEGMENT_WORDS]; status && (e.n_primes > 0) && (k < k1); ) {
+			size_t const z = ((k1 - k) < SIEVE_SEGMENT_BYTES) ? (k1 - k) : SIEVE_SEGMENT_BYTES;
+			uint8_t const *p = cache + PRIME_CACHE_HEADER + k;
+			for(size_t i = 0; i < z; i += sizeof(uint64_t)) {
+				if((z - i) >= sizeof(uint64_t)) {
+					bits[i / sizeof(uint64_t)] = getu64le(p + i);
+				} else {
+					uint64_t w = 0;
+					memcpy(&w, p + i, z - i);
+					bits[i / sizeof(uint64_t)] = leswapbytes(w);
+				}
+			}
+			status = emit_bits(&e, lo + (30 * (uintmax_t)k), bits, 8 * z);
+			k += z;
+		}
+	}
+
+	if(timed && status) {
+		print_time_per_prime(timed, &t1, e.n_found);
+	}
+
+	return status;
+}
+
+//------------------------------------------------------------------------------
+
+static int
+process_sieve(
+	uintmax_t const range_min,
+	uintmax_t const range_max,
+	uintmax_t const ends_with,
+	size_t    const n_primes,
+	bool      const as_hex,
+	int       const timed,
+	bool      const list,
+	bool      const windowed
+) {
+	// a windowed sieve only pre-sieves with the small base primes, so that
+	// its memory does not depend on the range; survivors above the square of
+	// the limit are then tested directly
+	uintmax_t const lim = windowed ? SIEVE_SMALL_LIMIT : sqrtumax(range_max);
+
+	struct timespec t1;
+	timestamp(timed, &t1);
+
+	struct emitter e;
+	emitter_init(&e, range_min, range_max, ends_with, n_primes, as_hex, list);
+	if(windowed) {
+		e.sq = lim * lim;
+	}
+
+	FILE *cachef = NULL;
+	if(cache_file) {
+		if(windowed) {
+			errorf("a prime cache needs the full sieve");
+			return false;
+		}
+		cachef = prime_cache_create(cache_file, range_min, range_max);
+		if(unlikely(!cachef)) {
+			return false;
+		}
+	}
+
+	struct sieve sieve;
+	bool status = sieve_init(&sieve, range_min, range_max, lim);
+	if(unlikely(!status)) {
+		errorf("unable to allocate sieve");
+		goto error_return;
+	}
+
+	status = emit_wheel_primes(&e);
+	while(status && (e.n_primes > 0) && sieve_segment(&sieve)) {
+		if(cachef) {
+			status = prime_cache_write(cachef, sieve.bits, sieve.n / 8);
+		}
+		if(status) {
+			status = emit_bits(&e, sieve.lo, sieve.bits, sieve.n);
+		}
+	}
+
+	if(timed && status) {
+		print_time_per_prime(timed, &t1, e.n_found);
+	}
+error_return:
+	sieve_clear(&sieve);
+	if(cachef && unlikely(fclose(cachef) != 0) && status) {
+		errorf("unable to write prime cache: %s", cache_file);
+		status = false;
+	}
+
+	return status;
+}
+
+static int
+process_sieve_threads(
+	uintmax_t const range_min,
+	uintmax_t const range_max,
+	uintmax_t const ends_with,
+	size_t    const n_primes,
+	bool      const as_hex,
+	int       const timed,
+	bool      const list,
+	size_t    const n_threads
+) {
+	struct timespec t1;
+	timestamp(timed, &t1);
+
+	struct emitter e;
+	emitter_init(&e, range_min, range_max, ends_with, n_primes, as_hex, list);
+
+	FILE *cachef = NULL;
+	if(cache_file) {
+		cachef = prime_cache_create(cache_file, range_min, range_max);
+		if(unlikely(!cachef)) {
+			return false;
+		}
+	}
+
+	struct sieve       sieve;
+	struct sieve_pool *t = NULL;
+	bool status = sieve_init(&sieve, range_min, range_max, sqrtumax(range_max));
+	if(unlikely(!status)) {
+		errorf("unable to allocate sieve");
+		goto error_return;
+	}
+	t = new_sieve_pool(&sieve, n_threads);
+	if(unlikely(!t)) {
+		errorf("unable to start sieve threads");
+		status = false;
+		goto error_return;
+	}
+
+	status = emit_wheel_primes(&e);
+
+	pthread_mutex_lock(&t->lock);
+	for(size_t n_emitted = 0; status && (e.n_primes > 0); ) {
+		while(((t->n_queued - n_emitted) < t->n_slots) && sieve_pool_queue(t))
+			;
+		if(t->quit) {
+			status = false;
+			break;
+		}
+		if(n_emitted == t->n_queued) break;
+
+		struct sieve_job *j = &t->slot[n_emitted % t->n_slots];
+		while(!t->quit && !j->done) {
+			pthread_cond_wait(&t->done, &t->lock);
+		}
+		if(t->quit) {
+			status = false;
+			break;
+		}
+		pthread_mutex_unlock(&t->lock);
+
+		if(cachef) {
+			status = prime_cache_write(cachef, j->bits, j->n);
+		}
+		if(status) {
+			status = emit_bits(&e, j->lo, j->bits, 8 * j->n);
+		}
+
+		pthread_mutex_lock(&t->lock);
+		j->done = false;
+		n_emitted++;
+	}
+	pthread_mutex_unlock(&t->lock);
+
+	if(timed && status) {
+		print_time_per_prime(timed, &t1, e.n_found);
+	}
+error_return:
+	if(t) del_sieve_pool(t);
+	sieve_clear(&sieve);
+	if(cachef && unlikely(fclose(cachef) != 0) && status) {
+		errorf("unable to write prime cache: %s", cache_file);
+		status = false;
+	}
+
+	return status;
+}
+
+//------------------------------------------------------------------------------
+
+// Prime counting by Meissel's formula, with a = pi(cbrt(x)) and b = pi(sqrt(x)):
+//
+//     pi(x) = phi(x, a) + a - 1 - P2(x, a)
+//     P2(x, a) = sum(i = a+1 .. b) pi(x / p_i) - (i - 1)
+//
+// where phi(x, a) counts the values <= x not divisible by the first a primes.
+// pi(y) for y up to about x^(2/3) is looked up in a sieved mod 30 bitmap,
+// with a running count for every 64 bits.
+
+enum {
+	PHI_C         = 6,
+	PHI_SMALL     = 30030,  // product of the first PHI_C primes
+	PI_TABLE_MIN  = 1 << 20
+};
+
+struct pi_table {
+	uintmax_t  limit;
+	uint64_t  *bits;
+	uintmax_t *count;
+	size_t     n_primes;
+	uint32_t  *primes;
+	uint16_t   phi[PHI_C + 1][PHI_SMALL];
+};
+
+// number of wheel residues <= each value mod 30
+static uint8_t const wheel_count[30] = {
+	0, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 4, 4,
+	4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7, 8
+};
+
+static uintmax_t
+cbrtumax(
+	uintmax_t v
+) {
+	// 2642245 is the largest cube root of a 64-bit value
+	uintmax_t lo = 0, hi = (v < 2642245) ? v : 2642245;
+	while(lo < hi) {
+		uintmax_t const m = hi - ((hi - lo) / 2);
+		if((m * m * m) <= v) lo = m;
+		else                 hi = m - 1;
+	}
+	return lo;
+}
+
+static inline uintmax_t
+pi_lookup(
+	struct pi_table const *t,
+	uintmax_t              y
+) {
+	static uint8_t const small[7] = { 0, 0, 1, 2, 2, 3, 3 };
+	if(y < 7) return small[y];
+	size_t   const g = (8 * (size_t)(y / 30)) + wheel_count[y % 30];
+	uint64_t const m = (g % 64) ? (t->bits[g / 64] & ~(~UINT64_C(0) << (g % 64))) : 0;
+	return sizeof(wheel_primes) + t->count[g / 64] + popcount(m);
+}
+
+static void
+pi_table_clear(
+	struct pi_table *t
+) {
+	free(t->bits);
+	free(t->count);
+	free(t->primes);
+	free(t);
+}
+
+static struct pi_table *
+new_pi_table(
+	uintmax_t limit,
+	uintmax_t p_limit
+) {
+	// sieve [0, limit], and keep the primes up to and one past p_limit
+	struct pi_table *t = malloc(sizeof(*t));
+	if(unlikely(!t)) return NULL;
+
+	size_t const n_words = (size_t)((limit / 30) / 8) + 1;
+	t->limit    = limit;
+	t->bits     = calloc(n_words, sizeof(*t->bits));
+	t->count    = malloc((n_words + 1) * sizeof(*t->count));
+	t->n_primes = 0;
+	t->primes   = NULL;
+	if(unlikely(!t->bits || !t->count)) goto error_return;
+
+	struct sieve sieve;
+	if(unlikely(!sieve_init(&sieve, 0, limit, sqrtumax(limit)))) goto error_return;
+	while(sieve_segment(&sieve)) {
+		memcpy(t->bits + ((sieve.lo / 30) / 8), sieve.bits, ((sieve.n / 8) + 7) / 8 * sizeof(*t->bits));
+	}
+	bool const failed = !sieve.end;
+	sieve_clear(&sieve);
+	if(unlikely(failed)) goto error_return;
+
+	uintmax_t c = 0;
+	for(size_t i = 0; i < n_words; i++) {
+		t->count[i] = c;
+		c += popcount(t->bits[i]);
+	}
+	t->count[n_words] = c;
+
+	size_t const n = pi_lookup(t, (p_limit < limit) ? p_limit : limit) + 1;
+	t->primes = malloc((n + 1) * sizeof(*t->primes));
+	if(unlikely(!t->primes)) goto error_return;
+	t->primes[t->n_primes++] = 0;
+	for(size_t k = 0; (k < sizeof(wheel_primes)) && (t->n_primes <= n); k++) {
+		t->primes[t->n_primes++] = wheel_primes[k];
+	}
+	for(size_t i = 0; (t->n_primes <= n) && (i < n_words); i++) {
+		for(uint64_t w = t->bits[i]; (t->n_primes <= n) && w; w &= w - 1) {
+			size_t const g = (64 * i) + tzcount(w);
+			t->primes[t->n_primes++] = (uint32_t)((30 * (g / 8)) + wheel_residue[g % 8]);
+		}
+	}
+	t->n_primes--;
+
+	for(size_t a = 0; (a <= PHI_C) && (t->n_primes > PHI_C); a++) {
+		uint16_t n = 0;
+		for(size_t r = 0; r < PHI_SMALL; r++) {
+			bool coprime = (r > 0);
+			for(size_t i = 1; coprime && (i <= a); i++) {
+				coprime = (r % t->primes[i]) != 0;
+			}
+			t->phi[a][r] = (n += coprime);
+		}
+	}
+	return t;
+
+error_return:
+	pi_table_clear(t);
+	return NULL;
+}
+
+static uintmax_t
+phi(
+	struct pi_table const *t,
+	uintmax_t              x,
+	size_t                 a
+) {
+	// t->primes[] is 1-based, and holds p_(a+1)
+	if(a == 0) return x;
+	if(a <= PHI_C) {
+		uintmax_t const p = t->phi[PHI_C][PHI_SMALL - 1];
+		if(a == PHI_C) return ((x / PHI_SMALL) * p) + t->phi[PHI_C][x % PHI_SMALL];
+		uintmax_t const z = (a == 1) ? 2 : (a == 2) ? 6 : (a == 3) ? 30 : (a == 4) ? 210 : 2310;
+		return ((x / z) * t->phi[a][z - 1]) + t->phi[a][x % z];
+	}
+	uintmax_t const q = t->primes[a + 1];
+	if(x < q) return (x > 0);
+	if((x <= t->limit) && (x < (q * q))) {
+		// only 1 and the primes above p_a are left
+		return pi_lookup(t, x) - a + 1;
+	}
+
+	uintmax_t sum = phi(t, x, PHI_C);
+	for(size_t i = PHI_C + 1; i <= a; i++) {
+		uintmax_t const p = t->primes[i];
+		uintmax_t const y = x / p;
+		if(y < p) {
+			// phi(y, i - 1) is 1 for each of the remaining p_i <= x
+			uintmax_t const n = pi_lookup(t, (x < t->primes[a]) ? x : t->primes[a]);
+			if(n >= i) sum -= n - i + 1;
+			break;
+		}
+		sum -= phi(t, y, i - 1);
+	}
+	return sum;
+}
+
+static bool
+prime_count(
+	uintmax_t  x,
+	uintmax_t *np
+) {
+	uintmax_t const c = cbrtumax(x);
+	uintmax_t const r = sqrtumax(x);
+	uintmax_t       l = x / (c + 1);
+	if(l < r) l = r;
+	if(l < PI_TABLE_MIN) l = (x < PI_TABLE_MIN) ? x : PI_TABLE_MIN;
+
+	struct pi_table *t = new_pi_table(l, c);
+	if(unlikely(!t)) return false;
+
+	if(x <= t->limit) {
+		*np = pi_lookup(t, x);
+	} else {
+		size_t const a = (size_t)pi_lookup(t, c);
+		size_t const b = (size_t)pi_lookup(t, r);
+		uintmax_t    n = phi(t, x, a) + a - 1;
+		// P2: step through the primes in (c, sqrt(x)]
+		size_t i = a;
+		for(size_t g = (8 * (size_t)(c / 30)) + wheel_count[c % 30]; i < b; g++) {
+			if(t->bits[g / 64] & (UINT64_C(1) << (g % 64))) {
+				uintmax_t const p = (30 * (uintmax_t)(g / 8)) + wheel_residue[g % 8];
+				n -= pi_lookup(t, x / p) - i;
+				i++;
+			}
+		}
+		*np = n;
+	}
+
+	pi_table_clear(t);
+	return true;
+}
+
+static int
+process_count(
+	uintmax_t const range_min,
+	uintmax_t const range_max,
+	bool      const as_hex,
+	int       const timed
+) {
+	if(unlikely(range_max == UINTMAX_MAX)) {
+		errorf("--count needs an upper bound, give one with -r MIN MAX");
+		return false;
+	}
+
+	struct timespec t1;
+	timestamp(timed, &t1);
+
+	uintmax_t n_max = 0, n_min = 0;
+	bool status = prime_count(range_max, &n_max)
+		&& ((range_min < 2) || prime_count(range_min - 1, &n_min));
+	if(unlikely(!status)) {
+		errorf("unable to allocate prime count tables");
+		return status;
+	}
+
+	if(unlikely(!print_value(n_max - n_min, as_hex) || !flush_output())) {
+		errorf("unable to write to output");
+		return false;
+	}
+
+	if(timed) {
+		struct timespec t2;
+		timestamp(timed, &t2);
+		time_interval(&t1, &t2, &t2);
+		print_time_interval(t2.tv_sec, t2.tv_nsec);
+		putchar('\n');
+	}
+
+	return status;
+}
+
+static int
+process (
+	bool    (*const is_prime)(
+		uintmax_t v
+	),
+	uintmax_t const range_min,
+	uintmax_t const range_max,
+	uintmax_t const ends_with,
+	size_t          n_primes,
+	bool      const as_hex,
+	int       const timed,
+	bool      const list,
+	size_t    const n_threads
+) {
+	if(cache) {
+		return process_cache(range_min, range_max, ends_with, n_primes, as_hex, timed, list);
+	}
+	if(!is_prime || (is_prime == is_prime__miller_rabin)) {
+		if(is_prime) {
+			return process_sieve(range_min, range_max, ends_with, n_primes, as_hex, timed, list, true);
+		}
+		if(n_threads > 1) {
+			return process_sieve_threads(range_min, range_max, ends_with, n_primes, as_hex, timed, list, n_threads);
+		}
+		return process_sieve(range_min, range_max, ends_with, n_primes, as_hex, timed, list, false);
+	}
+
+	if(cache_file) {
+		errorf("a prime cache needs the sieve");
+		return false;
+	}
+
+	// only the primes up to sqrt(MAX) are needed to test the candidates
+	primes_limit = sqrtumax(range_max);
+	primes_found = 0;
+	bool status = array_reserve(uint32_t, &primes, SIZE_BIT);
+	if(!status) {
+		return status;
+	}
+
+	uintmax_t const end_digits = end_digits_of(ends_with, as_hex);
+
+	uintmax_t v = 0;
 
 	static uintmax_t const primer[] = { 2, 3, 5, 7, 11 };
 	static size_t    const n_primer = sizeof(primer) / sizeof(primer[0]);
@@ -202,7 +1600,7 @@ process (
 				}
 			}
 
-			if(list && unlikely(fprintf(outf, fmt, v) < 0)) {
+			if(list && unlikely(!print_value(v, as_hex))) {
 				errorf("unable to write to output");
 				status = false;
 				goto error_return;
@@ -216,12 +1614,11 @@ process (
 	}
 	if(n_primes > 0) {
 		uintmax_t last_v = v;
-		unsigned  step   = 2;
-		bool      paired = false;
+		unsigned  wi     = wheel_index[v % 30];
 		struct timespec t1;
 		timestamp(timed, &t1);
 		if(range_min > 0) {
-			for(v += step; (v > last_v) && (v < range_min); v += step) {
+			for(v = wheel_step(v, &wi); (v > last_v) && (v < range_min); v = wheel_step(v, &wi)) {
 				if(is_prime(v)) {
 					last_v = v;
 
@@ -229,17 +1626,11 @@ process (
 					if(unlikely(!status)) {
 						goto error_return;
 					}
-
-					step   =  paired ? 4 : 2;
-					paired = !paired;
-				} else {
-					step   = 2;
-					paired = false;
 				}
 			}
 
 			if(end_digits > 0) {
-				for(; (v > last_v) && (v <= range_max); v += step) {
+				for(; (v > last_v) && (v <= range_max); v = wheel_step(v, &wi)) {
 					if(is_prime(v)) {
 						last_v = v;
 
@@ -253,7 +1644,7 @@ process (
 							continue;
 						}
 
-						if(list && unlikely(fprintf(outf, fmt, v) < 0)) {
+						if(list && unlikely(!print_value(v, as_hex))) {
 							errorf("unable to write to output");
 							status = false;
 							goto error_return;
@@ -263,17 +1654,11 @@ process (
 						if(unlikely(n_primes == 0)) {
 							break;
 						}
-
-						step   =  paired ? 4 : 2;
-						paired = !paired;
-					} else {
-						step   = 2;
-						paired = false;
 					}
 				}
 
 			} else /* if(end_digits > 0) */ {
-				for(; (v > last_v) && (v <= range_max); v += step) {
+				for(; (v > last_v) && (v <= range_max); v = wheel_step(v, &wi)) {
 					if(is_prime(v)) {
 						last_v = v;
 
@@ -282,7 +1667,7 @@ process (
 							goto error_return;
 						}
 
-						if(list && unlikely(fprintf(outf, fmt, v) < 0)) {
+						if(list && unlikely(!print_value(v, as_hex))) {
 							errorf("unable to write to output");
 							status = false;
 							goto error_return;
@@ -292,19 +1677,13 @@ process (
 						if(unlikely(n_primes == 0)) {
 							break;
 						}
-
-						step   =  paired ? 4 : 2;
-						paired = !paired;
-					} else {
-						step   = 2;
-						paired = false;
 					}
 				}
 			}
 
 		} else /* if(range_min > 0) */ {
 			if(end_digits > 0) {
-				for(v += step; (v > last_v) && (v <= range_max); v += step) {
+				for(v = wheel_step(v, &wi); (v > last_v) && (v <= range_max); v = wheel_step(v, &wi)) {
 					if(is_prime(v)) {
 						last_v = v;
 
@@ -318,7 +1697,7 @@ process (
 							continue;
 						}
 
-						if(list && unlikely(fprintf(outf, fmt, v) < 0)) {
+						if(list && unlikely(!print_value(v, as_hex))) {
 							errorf("unable to write to output");
 							status = false;
 							goto error_return;
@@ -328,17 +1707,11 @@ process (
 						if(unlikely(n_primes == 0)) {
 							break;
 						}
-
-						step   =  paired ? 4 : 2;
-						paired = !paired;
-					} else {
-						step   = 2;
-						paired = false;
 					}
 				}
 
 			} else /* if(end_digits > 0) */ {
-				for(v += step; (v > last_v) && (v <= range_max); v += step) {
+				for(v = wheel_step(v, &wi); (v > last_v) && (v <= range_max); v = wheel_step(v, &wi)) {
 					if(is_prime(v)) {
 						last_v = v;
 
@@ -347,7 +1720,7 @@ process (
 							goto error_return;
 						}
 
-						if(list && unlikely(fprintf(outf, fmt, v) < 0)) {
+						if(list && unlikely(!print_value(v, as_hex))) {
 							errorf("unable to write to output");
 							status = false;
 							goto error_return;
@@ -357,25 +1730,12 @@ process (
 						if(unlikely(n_primes == 0)) {
 							break;
 						}
-
-						step   =  paired ? 4 : 2;
-						paired = !paired;
-					} else {
-						step   = 2;
-						paired = false;
 					}
 				}
 			}
 		}
 		if(timed) {
-			struct timespec t2;
-			timestamp(timed, &t2);
-			time_interval(&t1, &t2, &t2);
-			time_per(&t2, primes.len, &t1);
-			print_time_interval(t2.tv_sec, t2.tv_nsec);
-			putstr(" = ");
-			print_time_interval(t1.tv_sec, t1.tv_nsec);
-			puts(" per prime");
+			print_time_per_prime(timed, &t1, primes_found);
 		}
 	}
 error_return:
@@ -410,6 +1770,12 @@ int main(int argc, char *argv[argc + 1])
 		{  6, "-d, --dec",                        "print values in decimal"},
 		{ 11, "-f, --for",                        "use for loop"},
 		{ 12, "-F, --foreach",                    "use foreach"},
+		{ 13, "-s, --sieve",                      "use segmented sieve (default)"},
+		{ 14, "-j, --jobs N",                     "sieve with N threads"},
+		{ 15, "-m, --miller-rabin",               "test pre-sieved candidates with Miller-Rabin"},
+		{ 16, "-c, --count",                      "count the primes between MIN and MAX"},
+		{ 17, "-w, --write-cache FILE",           "keep the sieved primes in prime cache FILE"},
+		{ 18, "-l, --load-cache FILE",            "list primes from prime cache FILE"},
 		{ 19, "-n, --no-output",                  "do not list prime numbers"},
 		{ 80, "-T, --utc-time",                   "timed execution" },
 #ifdef TIMESTAMP_REALTIME
@@ -429,6 +1795,7 @@ int main(int argc, char *argv[argc + 1])
 	int exit_status = EXIT_SUCCESS;
 
 	outf = stdout;
+	fmtbuf_init(&outb, outf);
 
 	size_t    n_primes  = 0;
 	uintmax_t ends_with = 0;
@@ -437,7 +1804,9 @@ int main(int argc, char *argv[argc + 1])
 	bool      as_hex    = false;
 	int       timed     = NO_TIMESTAMP;
 	bool      list      = true;
-	bool    (*is_prime)(uintmax_t v) = is_prime__foreach;
+	size_t    n_threads = 1;
+	bool      count     = false;
+	bool    (*is_prime)(uintmax_t v) = NULL;
 
 	for(int i = 1; i < argc; ) {
 		char const *args = argv[i++];
@@ -457,7 +1826,11 @@ int main(int argc, char *argv[argc + 1])
 						goto invalid_option;
 					}
 				}
-				if(0 > process(is_prime, range_min, range_max, ends_with, n_primes, as_hex, timed, list)) {
+				if(!(count ? (
+					process_count(range_min, range_max, as_hex, timed)
+				):(
+					process(is_prime, range_min, range_max, ends_with, n_primes, as_hex, timed, list, n_threads)
+				)) || !flush_output()) {
 					exit_status = EXIT_FAILURE;
 					goto end;
 				}
@@ -466,10 +1839,12 @@ int main(int argc, char *argv[argc + 1])
 				optuse(n_options, options, argv[0], stdout);
 				goto end;
 			case 2:
+				flush_output();
 				if(outf != stdout) {
 					fclose(outf);
 				}
 				outf = fopen(argv[i], "w");
+				fmtbuf_init(&outb, outf);
 				if(!outf) {
 					errorf("unable to open output file: %s", argv[i]);
 					exit_status = EXIT_FAILURE;
@@ -508,6 +1883,31 @@ int main(int argc, char *argv[argc + 1])
 			case 12:
 				is_prime = is_prime__foreach;
 				break;
+			case 13:
+				is_prime = NULL;
+				break;
+			case 14:
+				n_threads = streval(argv[i], NULL, 0);
+				if((n_threads == 0) || (n_threads > SIEVE_MAX_THREADS)) {
+					goto invalid_option;
+				}
+				is_prime = NULL;
+				break;
+			case 15:
+				is_prime = is_prime__miller_rabin;
+				break;
+			case 16:
+				count = true;
+				break;
+			case 17:
+				cache_file = argv[i];
+				break;
+			case 18:
+				if(!prime_cache_load(argv[i])) {
+					exit_status = EXIT_FAILURE;
+					goto end;
+				}
+				break;
 			case 19:
 				list = false;
 				break;
@@ -538,7 +1938,11 @@ int main(int argc, char *argv[argc + 1])
 	if(0 == n_primes) {
 		n_primes = SIZE_MAX;
 
-		if(0 > process(is_prime, range_min, range_max, ends_with, n_primes, as_hex, timed, list)) {
+		if(!(count ? (
+			process_count(range_min, range_max, as_hex, timed)
+		):(
+			process(is_prime, range_min, range_max, ends_with, n_primes, as_hex, timed, list, n_threads)
+		)) || !flush_output()) {
 			exit_status = EXIT_FAILURE;
 		}
 	}
@@ -546,6 +1950,9 @@ end:
 	if(outf != stdout) {
 		fclose(outf);
 	}
+	if(cache) {
+		unmapfile(cache, cache_size);
+	}
 
 	return exit_status;
 }
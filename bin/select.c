@@ -44,22 +44,34 @@ signal_handler(
 
 //------------------------------------------------------------------------------
 
-static FILE       *out;
-static char const *out_name   = "";
-static bool        out_ispipe = false;
+static FILE         *out;
+static char const   *out_name   = "";
+static bool          out_ispipe = false;
+static bool          out_istty  = false;
+static struct fmtbuf outb;
 
 static inline int
 outchar(
 	int c
 ) {
-	return fputc(c, out);
+	return fmtbuf_putc(&outb, c);
+}
+
+// a terminal sees each line as it ends, not when the buffer fills
+static inline int
+outeol(
+	void
+) {
+	int const c = fmtbuf_putc(&outb, '\n');
+	if(out_istty) fmtbuf_flush(&outb);
+	return c;
 }
 
 static inline int
 outstr(
 	char const *cs
 ) {
-	return fputs(cs, out);
+	return fmtbuf_puts(&outb, cs);
 }
 
 //------------------------------------------------------------------------------
@@ -122,7 +134,7 @@ main(
 				out_name   = argv[argi];
 				out_ispipe = (*out_name == '=');
 				out_name  += out_ispipe;
-				out        = out_ispipe ? popen(out_name, "wb") : fopen(out_name, "wb");
+				out        = out_ispipe ? popen(out_name, POPEN_WB) : fopen(out_name, "wb");
 				if(!out) {
 					perror(out_name);
 					fail();
@@ -202,10 +214,13 @@ main(
 	_setmode(_fileno(stdin), _O_BINARY);
 	_setmode(_fileno(stdout), _O_BINARY);
 #endif
+	fmtbuf_init(&outb, out);
+	out_istty = isatty(fileno(out));
 	int c = 0;
 	for(size_t i; !gSignal;) {
 		if(scanf("%zi", &i) != 1) {
 			if(ferror(stdin)) {
+				fmtbuf_flush(&outb);
 				perror();
 				fail();
 			}
@@ -219,11 +234,15 @@ main(
 		}
 		outstr(arga[i]);
 		if(c == columns) {
-			outchar('\n');
+			outeol();
 			c = 0;
 		}
 	}
-	if(c > 0) outchar('\n');
+	if(c > 0) outeol();
+	if(fmtbuf_flush(&outb) != 0) {
+		perror(out_name);
+		fail();
+	}
 
 	return 0;
 }
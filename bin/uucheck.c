@@ -0,0 +1,155 @@
+/*
+MIT License
+
+Copyright (c) 2023 Tristan Styles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//------------------------------------------------------------------------------
+
+// checks the xtdint.h double-word multiply and divide; build it once as is,
+// and once with -DXTDINT_PORTABLE, then the digests of the two runs must be
+// the same. Where the compiler has 128-bit integers each result is also
+// checked against them directly.
+
+#include <hol/holibc.h>
+
+#if defined(__SIZEOF_INT128__) && (UINTMAX_MAX == UINT64_MAX)
+#	define UUCHECK_INT128  1
+#endif
+
+#if defined(XTDINT__INT128)
+#	define UUCHECK_BACKEND  "int128"
+#elif defined(XTDINT__MSVC64)
+#	define UUCHECK_BACKEND  "msvc64"
+#else
+#	define UUCHECK_BACKEND  "portable"
+#endif
+
+//------------------------------------------------------------------------------
+
+static XRAND64 R;
+
+static uint64_t digest     = UINT64_C(0xCBF29CE484222325);
+static size_t   mismatches = 0;
+
+static inline void
+fold(
+	uintmax_t v
+) {
+	digest = (digest ^ (uint64_t)v) * UINT64_C(0x100000001B3);
+	digest = rotl(digest, 29);
+}
+
+// mostly random words, with enough zeros, ones, small values, powers of two
+// and their neighbours to reach the special cases of each backend
+static uintmax_t
+operand(
+	void
+) {
+	uint64_t const r = xrand64(&R);
+	uint64_t const v = xrand64(&R);
+	int      const n = (int)(v % 64);
+	switch(r % 16) {
+	case 0:  return 0;
+	case 1:  return 1;
+	case 2:  return ~UINTMAX_C(0);
+	case 3:  return v & UINT32_MAX;
+	case 4:  return v & 0xFF;
+	case 5:  return (uintmax_t)1 << n;
+	case 6:  return ((uintmax_t)1 << n) - 1;
+	case 7:  return ((uintmax_t)1 << n) + 1;
+	default: return v;
+	}
+}
+
+static void
+mismatch(
+	char const *op,
+	uintmax_t   ah,
+	uintmax_t   al,
+	uintmax_t   b,
+	uintmax_t   c
+) {
+	if(mismatches++ < 16) {
+		printf("%s mismatch: %016"PRIxMAX":%016"PRIxMAX" %016"PRIxMAX" %016"PRIxMAX"\n", op, ah, al, b, c);
+	}
+}
+
+static void
+check(
+	uintmax_t ah,
+	uintmax_t al,
+	uintmax_t b,
+	uintmax_t c
+) {
+	uintmax_t mh, ml, ph, pl, sh, sl, qh, ql, r;
+	uumulu(ah, al, b, &mh, &ml);
+	uumadu(ah, al, b, c, &ph, &pl);
+	uumsbu(ah, al, b, c, &sh, &sl);
+	r = uudivu(ah, al, b, &qh, &ql);
+	fold(mh); fold(ml);
+	fold(ph); fold(pl);
+	fold(sh); fold(sl);
+	fold(qh); fold(ql); fold(r);
+#ifdef UUCHECK_INT128
+	unsigned __int128 const a = ((unsigned __int128)ah << 64) | al;
+	unsigned __int128 const m = a * b;
+	unsigned __int128 const p = m + c;
+	unsigned __int128 const s = m - c;
+	unsigned __int128 const q = b ? (a / b) : ~(unsigned __int128)0;
+	uintmax_t         const t = b ? (uintmax_t)(a % b) : 0;
+	if((mh != (uintmax_t)(m >> 64)) || (ml != (uintmax_t)m)) mismatch("uumulu", ah, al, b, c);
+	if((ph != (uintmax_t)(p >> 64)) || (pl != (uintmax_t)p)) mismatch("uumadu", ah, al, b, c);
+	if((sh != (uintmax_t)(s >> 64)) || (sl != (uintmax_t)s)) mismatch("uumsbu", ah, al, b, c);
+	if((qh != (uintmax_t)(q >> 64)) || (ql != (uintmax_t)q) || (r != t)) mismatch("uudivu", ah, al, b, c);
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+int
+main(
+	int    argc,
+	char **argv
+) {
+	if((argc > 3) || ((argc > 1) && !isdigit(*argv[1]))) {
+		puts("usage: uucheck [COUNT [SEED]]");
+		return 0;
+	}
+	size_t   const count = (argc > 1) ? strtozs(argv[1], NULL, 0) : 1000000;
+	uint64_t const seed  = (argc > 2) ? strtoull(argv[2], NULL, 0) : 1;
+	xseed64(&R, seed);
+
+	for(size_t i = 0; i < count; i++) {
+		uintmax_t const ah = operand();
+		uintmax_t const al = operand();
+		uintmax_t const b  = operand();
+		uintmax_t const c  = operand();
+		check(ah, al, b, c);
+	}
+
+	printf("%s: %zu operands, digest %016"PRIx64"\n", UUCHECK_BACKEND, count, digest);
+	if(mismatches > 0) {
+		printf("%zu mismatches\n", mismatches);
+		return EXIT_FAILURE;
+	}
+	return 0;
+}
@@ -221,7 +221,7 @@ vlqbe_tostr(
 ) {
 	uint64_t v;
 	uint8_t  b;
-	size_t   j = countNbit(u, 7);
+	size_t   j = vlqlen(u);
 	while(j-- > 1) {
 		v = (u >> (7 * j)) & 0x7Fu;
 		b = 0x80u | v;
@@ -240,7 +240,7 @@ vlqle_tostr(
 ) {
 	uint64_t v;
 	uint8_t  b;
-	size_t   j = countNbit(u, 7);
+	size_t   j = vlqlen(u);
 	while(j-- > 1) {
 		v = u & 0x7Fu;
 		b = 0x80u | v;
@@ -255,6 +255,89 @@ vlqle_tostr(
 
 //------------------------------------------------------------------------------
 
+#define BLOCK_WORDS  (64 Ki)
+
+static uint64_t words[BLOCK_WORDS];
+static uint8_t  bytes[BLOCK_WORDS * VLQ_MAX_LEN];
+
+static bool
+outbytes(
+	void const *p,
+	size_t      n
+) {
+	if(fwrite(p, 1, n, out) != n) {
+		perror(out_name);
+		return false;
+	}
+	return true;
+}
+
+static bool
+encode_binary(
+	bool little
+) {
+	size_t m = 0;
+	for(size_t r; !gSignal && ((r = fread((uint8_t *)words + m, 1, sizeof(words) - m, in)) > 0); ) {
+		m += r;
+		size_t const n = m / sizeof(*words);
+		for(size_t i = 0; i < n; i++) {
+			words[i] = leswapbytes(words[i]);
+		}
+		size_t const z = little ? vlqle_encode(bytes, words, n) : vlqbe_encode(bytes, words, n);
+		if(!outbytes(bytes, z)) return false;
+		m -= n * sizeof(*words);
+		memmove(words, words + n, m);
+	}
+	if(ferror(in)) {
+		perror(in_name);
+		return false;
+	}
+	if(m > 0) {
+		errorf("incomplete 64-bit word in %s", *in_name ? in_name : "stdin");
+		return false;
+	}
+	return true;
+}
+
+static bool
+decode_binary(
+	bool little
+) {
+	size_t m = 0;
+	for(size_t r; !gSignal && ((r = fread(bytes + m, 1, sizeof(bytes) - m, in)) > 0); ) {
+		m += r;
+		size_t i = 0;
+		for(;;) {
+			size_t n = BLOCK_WORDS;
+			errno = 0;
+			size_t const j = little ? vlqle_decode(words, &n, bytes + i, m - i) : vlqbe_decode(words, &n, bytes + i, m - i);
+			if(errno) {
+				errorf("invalid VLQ in %s", *in_name ? in_name : "stdin");
+				return false;
+			}
+			if(n == 0) break;
+			i += j;
+			for(size_t k = 0; k < n; k++) {
+				words[k] = leswapbytes(words[k]);
+			}
+			if(!outbytes(words, n * sizeof(*words))) return false;
+		}
+		m -= i;
+		memmove(bytes, bytes + i, m);
+	}
+	if(ferror(in)) {
+		perror(in_name);
+		return false;
+	}
+	if(m > 0) {
+		errorf("incomplete VLQ in %s", *in_name ? in_name : "stdin");
+		return false;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+
 #ifndef NDEBUG
 int
 main(
@@ -281,6 +364,7 @@ main(
 		{  2, "-o, --output FILE",       "output to FILE" },
 		{ 10, "-e, --encode",            "encode values" },
 		{ 11, "-l, --little-endian",     "little-endian format" },
+		{ 12, "-b, --binary",            "binary format, values as 64-bit little-endian words" },
 		{ 99, "-I, --ignore-interrupts", "ignore interrupt signals" },
 	};
 	static size_t const n_options = (sizeof(options) / sizeof(options[0]));
@@ -291,6 +375,8 @@ main(
 	bool       encode                            = false;
 	uint64_t (*strto_vlq)(char const *, char **) = strto_vlqbe;
 	char    *(*vlq_tostr)(uint64_t, char *)      = vlqbe_tostr;
+	bool       little                            = false;
+	bool       binary                            = false;
 	bool       ignore_interrupts                 = false;
 
 	int argi = 1;
@@ -311,7 +397,7 @@ main(
 				out_name   = argv[argi];
 				out_ispipe = (*out_name == '=');
 				out_name  += out_ispipe;
-				out        = out_ispipe ? popen(out_name, "wb") : fopen(out_name, "wb");
+				out        = out_ispipe ? popen(out_name, POPEN_WB) : fopen(out_name, "wb");
 				if(!out) {
 					perror(out_name);
 					fail();
@@ -323,6 +409,10 @@ main(
 			case 11:
 				strto_vlq = strto_vlqle;
 				vlq_tostr = vlqle_tostr;
+				little    = true;
+				break;
+			case 12:
+				binary = true;
 				break;
 			case 99:
 				ignore_interrupts = true;
@@ -354,12 +444,18 @@ main(
 			in_name   = argv[argi++];
 			in_ispipe = (*in_name == '=');
 			in_name  += in_ispipe;
-			in        = in_ispipe ? popen(in_name, "rb") : fopen(in_name, "rb");
+			in        = in_ispipe ? popen(in_name, POPEN_RB) : fopen(in_name, "rb");
 			if(!in) {
 				perror(in_name);
 				fail();
 			}
 		}
+		if(binary) {
+			if(!(encode ? encode_binary(little) : decode_binary(little))) {
+				fail();
+			}
+			continue;
+		}
 		bool interactive = isatty(fileno(out)) && isatty(fileno(in));
 		for(char const *cs; !gSignal; ) {
 			if(interactive) outchar('>');
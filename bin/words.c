@@ -104,7 +104,16 @@ add_word_list(
 
 static size_t       insertion_count = 0;
 static size_t       deletion_count  = 0;
+static size_t       exclusion_count = 0;
+static size_t       filtered_count  = 0;
 static struct hampt word_table      = HAMPT();
+static struct hset  word_set        = HSET();
+static bool         use_hset        = false;
+static void const  *exclude_table   = NULL;
+static uint64_t     exclude_mask    = 0;
+static size_t       exclude_size    = 0;
+static struct bloom *word_bloom     = NULL;
+static struct quotf *word_quotf     = NULL;
 static size_t       word_count      = 0;
 static size_t       collisions      = 0;
 static size_t       repetitions     = 0;
@@ -113,12 +122,198 @@ static size_t       max_chain       = 0;
 
 //------------------------------------------------------------------------------
 
+static inline void **
+word_table_lookup(
+	uint64_t h
+) {
+	return use_hset ? hset_lookup(&word_set, h) : hampt_lookup(&word_table, h);
+}
+
+static inline void **
+word_table_insert(
+	uint64_t h
+) {
+	return use_hset ? hset_insert(&word_set, h) : hampt_insert(&word_table, h);
+}
+
+static inline void
+word_table_remove(
+	uint64_t h
+) {
+	if(use_hset) hset_remove(&word_set, h);
+	else         hampt_remove(&word_table, h);
+}
+
+static inline void
+word_filter_add(
+	uint64_t h
+) {
+	if(word_bloom) bloom_add(word_bloom, h);
+	// an overfull quotient filter can no longer answer for the table
+	if(word_quotf && !quotf_add(word_quotf, h)) {
+		del_quotf(word_quotf);
+		word_quotf = NULL;
+	}
+}
+
+static inline bool
+word_filter_has(
+	uint64_t h
+) {
+	if(word_bloom) return bloom_has(word_bloom, h);
+	if(word_quotf) return quotf_has(word_quotf, h);
+	return true;
+}
+
+static inline int
+word_table_walk(
+	int (*cb)(void *, void *, int),
+	void *c
+) {
+	return use_hset ? hset_walk(&word_set, cb, c, 1) : hampt_walk(&word_table, cb, c, 1);
+}
+
+static inline void
+word_table_clear(
+	void (*cb)(void *)
+) {
+	if(use_hset) hset_clear(&word_set, cb);
+	else         hampt_clear(&word_table, cb);
+}
+
+//------------------------------------------------------------------------------
+
 struct context {
 	uint64_t mask;
 	int      minlen;
 	int      maxlen;
 };
 
+// Word table image payload, per leaf:
+//     count, { length, characters, '\0', padding }[count]
+// where count and length are 64-bit little-endian values, and padding aligns
+// to 64-bits.
+
+static uint64_t
+put_word_image(
+	struct word const  *w,
+	struct hampt_image *ip
+) {
+	uint8_t n[sizeof(uint64_t)];
+	setu64le(w->n, n);
+	uint64_t o = hampt_image_append(ip, n, sizeof(n));
+	hampt_image_append(ip, w->s, w->n + 1);
+	return o;
+}
+
+static uint64_t
+put_words_image(
+	void               *p,
+	struct hampt_image *ip,
+	void               *c
+) {
+	(void)c;
+	uint8_t n[sizeof(uint64_t)];
+	if(!is_tagged_pointer(p)) {
+		setu64le(1, n);
+		uint64_t o = hampt_image_append(ip, n, sizeof(n));
+		put_word_image(p, ip);
+		return o;
+	}
+	struct spa *a = untag_pointer(p);
+	setu64le(a->n, n);
+	uint64_t o = hampt_image_append(ip, n, sizeof(n));
+	for(size_t i = 0; i < a->n; i++) {
+		put_word_image(a->p[i], ip);
+	}
+	return o;
+}
+
+// N[/P]: a filter sized for N words with a false positive rate of P, by
+// default 0.01
+static bool
+strtofilter(
+	char const *cs,
+	size_t     *np,
+	double     *pp
+) {
+	char *s;
+	*np = strtoz(cs, &s, 0);
+	*pp = 0.01;
+	if((s != cs) && (*s == '/')) {
+		char const *t = s + 1;
+		*pp = strtod(t, &s);
+		if(s == t) return false;
+	}
+	return (s != cs) && (*s == '\0') && (*pp > 0.0) && (*pp < 1.0);
+}
+
+static bool
+is_excluded_word(
+	struct word const *w
+) {
+	uint64_t       h = memhash(w->s, w->n) & exclude_mask;
+	uint8_t const *b = hampt_image_lookup(exclude_table, h);
+	if(b) {
+		// the payload is read only as far as the end of the image
+		uint8_t const *e = (uint8_t const *)exclude_table + exclude_size;
+		if((size_t)(e - b) < sizeof(uint64_t)) return false;
+		uint64_t n = getu64le(b);
+		for(b += sizeof(uint64_t); (n-- > 0) && ((size_t)(e - b) >= sizeof(uint64_t)); ) {
+			uint64_t z = getu64le(b);
+			b += sizeof(uint64_t);
+			if(z >= (size_t)(e - b)) break;
+			if(mcompare(b, z, w->s, w->n) == 0) {
+				return true;
+			}
+			if(roundup(sizeof(uint64_t), z + 1) > (size_t)(e - b)) break;
+			b += roundup(sizeof(uint64_t), z + 1);
+		}
+	}
+	return false;
+}
+
+static int
+add_word_trie(
+	void *p,
+	void *c,
+	int   d
+) {
+	(void)d;
+	struct context const *ctx = c;
+	struct word    const *w   = is_tagged_pointer(p) ? ((struct spa *)untag_pointer(p))->p[0] : p;
+	void                **qp  = hampt_insert(&word_table, memhash(w->s, w->n) & ctx->mask);
+	if(unlikely(!qp)) return -1;
+	*qp = p;
+	return 0;
+}
+
+static bool
+write_word_table(
+	char const           *file,
+	struct context const *ctx
+) {
+	// images are built from the trie, so copy the set entries into one first
+	if(use_hset && (hset_walk(&word_set, add_word_trie, (void *)ctx, 1) != 0)) {
+		hampt_clear(&word_table);
+		return false;
+	}
+	struct hampt_image image = HAMPT_IMAGE();
+	bool built = hampt_image_build(&image, &word_table, ctx->mask, put_words_image, NULL);
+	if(use_hset) hampt_clear(&word_table);
+	if(!built) {
+		return false;
+	}
+	bool  ok = false;
+	FILE *f  = fopen(file, "wb");
+	if(f) {
+		ok = (fwrite(image.p, 1, image.n, f) == image.n);
+		ok = (fclose(f) == 0) && ok;
+	}
+	hampt_image_clear(&image);
+	return ok;
+}
+
 static int
 add_word(
 	struct word *w,
@@ -130,10 +325,15 @@ add_word(
 		return 0;
 	}
 
+	if(exclude_table && is_excluded_word(w)) {
+		exclusion_count++;
+		return 0;
+	}
+
 	insertion_count++;
 
 	uint64_t h  = memhash(w->s, w->n) & ctx->mask;
-	void   **qp = hampt_insert(&word_table, h);
+	void   **qp = word_table_insert(h);
 	void    *q  = *qp;
 	if(q) {
 		struct spa *a  = NULL;
@@ -157,6 +357,7 @@ add_word(
 		*qp = tag_pointer(a);
 	} else {
 		*qp = w;
+		word_filter_add(h);
 	}
 	word_count++;
 	return 1;
@@ -176,14 +377,18 @@ del_word(
 	deletion_count++;
 
 	uint64_t h  = memhash(w->s, w->n) & ctx->mask;
-	void   **qp = hampt_lookup(&word_table, h);
+	if(!word_filter_has(h)) {
+		filtered_count++;
+		return 0;
+	}
+	void   **qp = word_table_lookup(h);
 	if(qp) {
 		void *q = *qp;
 		if(is_tagged_pointer(q)) {
 			struct spa *a = untag_pointer(q);
 			w = spa_remove(&a, wordcmp, w, 0);
 			if(w) {
-				if(!a) hampt_remove(&word_table, h);
+				if(!a) word_table_remove(h);
 				else if(a->n > 1) *qp = tag_pointer(a);
 				else *qp = a->p[0], free(a);
 				word_count--;
@@ -191,7 +396,7 @@ del_word(
 			}
 		} else {
 			if(wordcmp(q, w, 0) == 0) {
-				hampt_remove(&word_table, h);
+				word_table_remove(h);
 				word_count--;
 				return -1;
 			}
@@ -367,6 +572,8 @@ main(
 		{ 83, "    --cpu-time",    NULL },
 #endif
 		{  6, "-M, --in-memory",   "pre-load FILE words into memory" },
+		{  7, "-w, --write TABLE", "write word table to TABLE" },
+		{  8, "-x, --exclude TABLE", "exclude words in word table TABLE" },
 		{ 99, "-I, --ignore-interrupts", "ignore interrupt signals" },
 
 		{ 10, "-i, --ident",       "filter for identifier characters (default)" },
@@ -376,6 +583,11 @@ main(
 		{ 14, "-a, --alpha",       "filter for alphabetic characters" },
 		{ 15, "-z, --size MIN MAX","filter for size between MIN and MAX" },
 
+		{ 25, "-S, --hash-set",    "use hash set word table" },
+		{ 26, "-P, --hash-trie",   "use hash trie word table (default)" },
+		{ 27, "-F, --bloom-filter N[/P]", "pre-filter deletions with a bloom filter for N words, false positive rate P" },
+		{ 28, "-Q, --quotient-filter N[/P]", "pre-filter deletions with a quotient filter for N words, false positive rate P" },
+
 		{ 24, "-8, --64-bit",      "use 8-byte/64-bit hash mask (default)" },
 		{ 23, "-6, --48-bit",      "use 6-byte/48-bit hash mask" },
 		{ 22, "-4, --32-bit",      "use 4-byte/32-bit hash mask" },
@@ -401,6 +613,9 @@ main(
 	int             (*is_ctype)(int)                   = isident;
 	int             (*action  )(struct word *, void *) = add_word;
 	bool              stats                            = false;
+	char const       *write_file                       = NULL;
+	size_t            filter_n;
+	double            filter_p;
 	struct context    ctx = {
 		.mask   = UINT64_C(~0),
 		.minlen = INT_MIN,
@@ -425,6 +640,20 @@ main(
 				}
 				break;
 			case 6: inmem = true; break;
+			case 7: write_file = argv[argi]; break;
+			case 8:
+				if(exclude_table) unmapfile((void *)exclude_table, exclude_size);
+				exclude_table = mapfile(argv[argi], &exclude_size);
+				if(!exclude_table) {
+					perror(argv[argi]);
+					fail();
+				}
+				if(!hampt_image_check(exclude_table, exclude_size)) {
+					errorf("invalid word table: %s", argv[argi]);
+					fail();
+				}
+				exclude_mask = hampt_image_key(exclude_table);
+				break;
 			case 10: is_ctype = isident; break;
 			case 11: is_ctype = isprint; break;
 			case 12: is_ctype = isgraph; break;
@@ -434,6 +663,34 @@ main(
 				ctx.minlen = atoi(argv[argi]);
 				ctx.maxlen = atoi(argv[argi+1]);
 				break;
+			case 25: use_hset = true;  break;
+			case 26: use_hset = false; break;
+			case 27:
+				if(!strtofilter(argv[argi], &filter_n, &filter_p)) {
+					errorf("invalid filter size: %s", argv[argi]);
+					fail();
+				}
+				del_quotf(word_quotf), word_quotf = NULL;
+				del_bloom(word_bloom);
+				word_bloom = new_bloom(filter_n, filter_p);
+				if(!word_bloom) {
+					perror(args);
+					fail();
+				}
+				break;
+			case 28:
+				if(!strtofilter(argv[argi], &filter_n, &filter_p)) {
+					errorf("invalid filter size: %s", argv[argi]);
+					fail();
+				}
+				del_bloom(word_bloom), word_bloom = NULL;
+				del_quotf(word_quotf);
+				word_quotf = new_quotf(filter_n, filter_p);
+				if(!word_quotf) {
+					perror(args);
+					fail();
+				}
+				break;
 			case 24: ctx.mask = UINT64_C(~0);       break;
 			case 23: ctx.mask = UINT64_C(~0) >> 16; break;
 			case 22: ctx.mask = UINT64_C(~0) >> 32; break;
@@ -525,13 +782,23 @@ main(
 		}
 	}
 
-	hampt_walk(&word_table, walker, NULL, 1);
+	if(write_file && !write_word_table(write_file, &ctx)) {
+		perror(write_file);
+		fail();
+	}
+
+	word_table_walk(walker, NULL);
 	if(inmem) {
 		while(word_list) word_list = del_word_list(word_list);
-		hampt_clear(&word_table);
+		word_table_clear(NULL);
 	} else {
-		hampt_clear(&word_table, freewords);
+		word_table_clear(freewords);
+	}
+	if(exclude_table) {
+		unmapfile((void *)exclude_table, exclude_size);
 	}
+	del_bloom(word_bloom);
+	del_quotf(word_quotf);
 
 	timestamp(timed, &rt2);
 
@@ -540,6 +807,8 @@ main(
 	if(stats) {
 		printf("%*zu words\n", d, word_count);
 		printf("%*zu repetitions\n", d, repetitions);
+		if(exclude_table) printf("%*zu exclusions\n", d, exclusion_count);
+		if(filtered_count) printf("%*zu filtered deletions\n", d, filtered_count);
 		printf("%*zu collisions\n", d, collisions);
 		printf("%*i.%zu depth\n", d, max_depth, max_chain);
 	}
@@ -25,6 +25,7 @@ SOFTWARE.
 */
 
 #include <hol/xtdlib.h>
+#include <hol/lebe.h>
 
 //------------------------------------------------------------------------------
 
@@ -62,6 +63,37 @@ hampt_remove(
 
 //------------------------------------------------------------------------------
 
+// A hampt image is a position-independent copy of a hampt, and the payloads
+// of its leaves, in a single block of memory; pointers are replaced by byte
+// offsets from the start of the image, and all fields are stored as 64-bit
+// little-endian values, so an image may be written to a file and later used
+// in-place, e.g. from a read-only mapping.
+
+struct hampt_image {
+	size_t   n;
+	size_t   z;
+	uint8_t *p;
+	bool     error;
+};
+#define HAMPT_IMAGE(...)  { .n = 0, .z = 0, .p = NULL, .error = false }
+
+extern uint64_t     hampt_image_append(struct hampt_image *ip, void const *p, size_t n);
+extern bool         hampt_image_build (struct hampt_image *ip, struct hampt const *mp, uint64_t key, uint64_t (*cb)(void *, struct hampt_image *, void *), void *c);
+extern bool         hampt_image_check (void const *image, size_t size);
+extern uint64_t     hampt_image_key   (void const *image);
+extern void const  *hampt_image_lookup(void const *image, uint64_t h);
+extern int          hampt_image_walk  (void const *image, int (*cb)(void const *, void *, int), void *c, int d);
+
+static inline void
+hampt_image_clear(
+	struct hampt_image *ip
+) {
+	free(ip->p);
+	*ip = (struct hampt_image)HAMPT_IMAGE();
+}
+
+//------------------------------------------------------------------------------
+
 #endif//ndef HOL_HAMPT_H__INCLUDED
 
 //------------------------------------------------------------------------------
@@ -281,4 +313,259 @@ hampt_walk(
 
 //------------------------------------------------------------------------------
 
+#include <string.h>
+
+enum {
+	HAMPT_IMAGE_ALIGN = sizeof(uint64_t),
+	HAMPT_IMAGE_MAGIC = 0,
+	HAMPT_IMAGE_KEY   = HAMPT_IMAGE_MAGIC + sizeof(uint64_t),
+	HAMPT_IMAGE_SIZE  = HAMPT_IMAGE_KEY   + sizeof(uint64_t),
+	HAMPT_IMAGE_ROOT  = HAMPT_IMAGE_SIZE  + sizeof(uint64_t),
+	HAMPT_IMAGE_DATA  = HAMPT_IMAGE_ROOT  + sizeof(uint64_t)
+};
+
+static char const hampt_image__magic[sizeof(uint64_t)] = "HAMPT\0\1";
+
+static uint64_t
+hampt_image__reserve(
+	struct hampt_image *ip,
+	size_t              n
+) {
+	if(ip->error) return 0;
+
+	size_t const o = ip->n;
+	size_t const m = roundup(HAMPT_IMAGE_ALIGN, n);
+	if(m > (ip->z - o)) {
+		size_t z = capacity_of(o + m);
+		void *p = realloc(ip->p, z);
+		if(unlikely(!p)) {
+			ip->error = true;
+			return 0;
+		}
+		ip->p = p;
+		ip->z = z;
+	}
+	memset(ip->p + o + n, 0, m - n);
+	ip->n = o + m;
+	return o;
+}
+
+uint64_t
+hampt_image_append(
+	struct hampt_image *ip,
+	void const         *p,
+	size_t              n
+) {
+	uint64_t const o = hampt_image__reserve(ip, n);
+	if(o && n) memcpy(ip->p + o, p, n);
+	return o;
+}
+
+static uint64_t
+hampt_image__put_map(
+	struct hampt const *mp,
+	struct hampt_image *ip,
+	uint64_t          (*cb)(void *, struct hampt_image *, void *),
+	void               *c
+) {
+	int is_node = is_tagged_pointer(mp->p);
+	if(is_node) {
+		struct hampt_node const *np = untag_pointer(mp->p);
+		size_t   const           n  = popcount(np->pop);
+		uint64_t const           o  = hampt_image__reserve(ip, sizeof(uint64_t) * (1 + n));
+		if(!o) return 0;
+		setu64le(np->pop, ip->p + o);
+		for(size_t i = 0; i < n; i++) {
+			uint64_t const s = hampt_image__put_map(&np->map[i], ip, cb, c);
+			if(!s) return 0;
+			setu64le(s, ip->p + o + (sizeof(uint64_t) * (1 + i)));
+		}
+		return o | 1;
+	}
+
+	struct hampt_leaf const *lp = mp->p;
+	uint64_t const           o  = hampt_image__reserve(ip, sizeof(uint64_t) * 2);
+	if(!o) return 0;
+	uint64_t const           q  = lp->p ? cb(lp->p, ip, c) : 0;
+	if(ip->error) return 0;
+	setu64le(lp->hash, ip->p + o);
+	setu64le(q,        ip->p + o + sizeof(uint64_t));
+	return o;
+}
+
+bool
+hampt_image_build(
+	struct hampt_image *ip,
+	struct hampt const *mp,
+	uint64_t            key,
+	uint64_t          (*cb)(void *, struct hampt_image *, void *),
+	void               *c
+) {
+	hampt_image_clear(ip);
+	hampt_image__reserve(ip, HAMPT_IMAGE_DATA);
+	if(!ip->error) {
+		memcpy(ip->p + HAMPT_IMAGE_MAGIC, hampt_image__magic, sizeof(hampt_image__magic));
+		setu64le(key, ip->p + HAMPT_IMAGE_KEY);
+		uint64_t const s = mp->p ? hampt_image__put_map(mp, ip, cb, c) : 0;
+		if(!ip->error) {
+			setu64le(s,     ip->p + HAMPT_IMAGE_ROOT);
+			setu64le(ip->n, ip->p + HAMPT_IMAGE_SIZE);
+			return true;
+		}
+	}
+	hampt_image_clear(ip);
+	return false;
+}
+
+// an image is only ever read through offsets checked to lie within its size,
+// and at most HAMPT_IMAGE_DEPTH nodes deep, however corrupt it may be
+
+enum {
+	HAMPT_IMAGE_DEPTH = (HAMPT_BITS_PER_HASH + HAMPT_BITS_PER_NODE - 1) / HAMPT_BITS_PER_NODE
+};
+
+static inline bool
+hampt_image__within(
+	uint64_t z,
+	uint64_t o,
+	uint64_t n
+) {
+	return (o >= HAMPT_IMAGE_DATA) && (o <= z) && (n <= (z - o));
+}
+
+// the node at s, or NULL if it does not fit within the image
+static uint8_t const *
+hampt_image__node(
+	uint8_t const *b,
+	uint64_t       z,
+	uint64_t       s
+) {
+	uint64_t const o = s & ~UINT64_C(1);
+	if(!hampt_image__within(z, o, sizeof(uint64_t))) return NULL;
+	uint64_t const n = popcount(getu64le(b + o));
+	if(!hampt_image__within(z, o, sizeof(uint64_t) * (1 + n))) return NULL;
+	return b + o;
+}
+
+// the leaf at s, or NULL if it, or its payload offset, is not within the image
+static uint8_t const *
+hampt_image__leaf(
+	uint8_t const *b,
+	uint64_t       z,
+	uint64_t       s
+) {
+	if(!hampt_image__within(z, s, sizeof(uint64_t) * 2)) return NULL;
+	uint64_t const q = getu64le(b + s + sizeof(uint64_t));
+	if(q && !hampt_image__within(z, q, 1)) return NULL;
+	return b + s;
+}
+
+// only the header and the root are checked, so that a mapped image is not paged
+// in whole: lookups and walks check every offset as they go
+static bool
+hampt_image__root(
+	uint8_t const *b,
+	uint64_t       z
+) {
+	uint64_t const s = getu64le(b + HAMPT_IMAGE_ROOT);
+	if(!s) return true;
+	return ((s & 1) ? hampt_image__node(b, z, s) : hampt_image__leaf(b, z, s)) != NULL;
+}
+
+bool
+hampt_image_check(
+	void const *image,
+	size_t      size
+) {
+	uint8_t const *b = image;
+	return b
+		&& (size >= HAMPT_IMAGE_DATA)
+		&& (memcmp(b + HAMPT_IMAGE_MAGIC, hampt_image__magic, sizeof(hampt_image__magic)) == 0)
+		&& (getu64le(b + HAMPT_IMAGE_SIZE) == size)
+		&& hampt_image__root(b, size)
+	;
+}
+
+uint64_t
+hampt_image_key(
+	void const *image
+) {
+	uint8_t const *b = image;
+	return getu64le(b + HAMPT_IMAGE_KEY);
+}
+
+void const *
+hampt_image_lookup(
+	void const *image,
+	uint64_t    h
+) {
+	uint8_t const *b = image;
+	uint64_t const z = getu64le(b + HAMPT_IMAGE_SIZE);
+	uint64_t       s = getu64le(b + HAMPT_IMAGE_ROOT);
+	if(s) for(int o = 0; ; o += HAMPT_BITS_PER_NODE) {
+		int is_node = s & 1;
+		if(is_node) {
+			uint8_t const *np = (o < HAMPT_BITS_PER_HASH) ? hampt_image__node(b, z, s) : NULL;
+			if(!np) break;
+			uint64_t const pop = getu64le(np);
+			size_t   const i   = (h >> o) & HAMPT_NODE_BIT_MASK;
+			uint64_t const m   = UINT64_C(1) << i;
+			uint64_t const x   = pop & (m - 1);
+			size_t   const j   = popcount(x);
+			if(!(pop & m)) break;
+			s = getu64le(np + (sizeof(uint64_t) * (1 + j)));
+			continue;
+		}
+
+		uint8_t const *lp = hampt_image__leaf(b, z, s);
+		if(lp && (getu64le(lp) == h)) {
+			uint64_t const q = getu64le(lp + sizeof(uint64_t));
+			return q ? b + q : NULL;
+		}
+		break;
+	}
+	return NULL;
+}
+
+static int
+hampt_image__walk(
+	uint8_t const *b,
+	uint64_t       z,
+	uint64_t       s,
+	int          (*cb)(void const *, void *, int),
+	void          *c,
+	int            d,
+	int            depth
+) {
+	int rc = 0;
+	if(s) {
+		int is_node = s & 1;
+		if(is_node) {
+			uint8_t const *np = (depth < HAMPT_IMAGE_DEPTH) ? hampt_image__node(b, z, s) : NULL;
+			int            d1 = d + 1;
+			if(np) for(size_t i = 0, n = popcount(getu64le(np)); i < n; i++) {
+				uint64_t const t = getu64le(np + (sizeof(uint64_t) * (1 + i)));
+				if((rc = hampt_image__walk(b, z, t, cb, c, d1, depth + 1)) != 0) break;
+			}
+		} else if(hampt_image__leaf(b, z, s)) {
+			uint64_t const q = getu64le(b + s + sizeof(uint64_t));
+			rc = cb(q ? b + q : NULL, c, d);
+		}
+	}
+	return rc;
+}
+
+int
+hampt_image_walk(
+	void const *image,
+	int       (*cb)(void const *, void *, int),
+	void       *c,
+	int         d
+) {
+	uint8_t const *b = image;
+	return hampt_image__walk(b, getu64le(b + HAMPT_IMAGE_SIZE), getu64le(b + HAMPT_IMAGE_ROOT), cb, c, d, 0);
+}
+
+//------------------------------------------------------------------------------
+
 #endif//def HOL_HAMPT_H__IMPLEMENTATION
@@ -0,0 +1,478 @@
+#ifndef HOL_HEXCODE_H__INCLUDED
+#define HOL_HEXCODE_H__INCLUDED  1
+/*
+MIT License
+
+Copyright (c) 2023 Tristan Styles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//------------------------------------------------------------------------------
+
+#include <hol/xtdlib.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+
+// HEXCODE: hexadecimal encoding and decoding of arrays of 1, 2, 4 or 8 byte
+//          values, each as 2 digits per byte, most significant first; with
+//          SSSE3 or AVX2 the digits are converted 16 or 32 bytes at a time.
+
+extern signed char const hexcode__value[256];
+
+static inline int
+hexdigit(
+	int c
+) {
+	return hexcode__value[(unsigned char)c];
+}
+
+extern size_t hexspan  (char const *cs, size_t m);
+extern void   hexencode(char *cs, void const *p, size_t n, size_t z, bool upper);
+extern size_t hexdecode(void *p, char const *cs, size_t n, size_t z);
+
+//------------------------------------------------------------------------------
+
+// HEXLAYOUT: values laid out as PREFIX DIGITS SUFFIX, optionally followed by
+//            a space; decoding follows scanf(" PREFIX%Nx SUFFIX"), so values
+//            may have fewer digits, and any space before them is skipped.
+
+struct hexlayout {
+	size_t      z;
+	bool        upper;
+	bool        spaced;
+	char const *prefix;
+	size_t      prefix_len;
+	char const *suffix;
+	size_t      suffix_len;
+};
+
+static inline void
+hexlayout_init(
+	struct hexlayout *hl,
+	size_t            z,
+	bool              upper,
+	char const       *prefix,
+	char const       *suffix,
+	bool              spaced
+) {
+	hl->z          = z;
+	hl->upper      = upper;
+	hl->spaced     = spaced;
+	hl->prefix     = prefix ? prefix : "";
+	hl->prefix_len = strlen(hl->prefix);
+	hl->suffix     = suffix ? suffix : "";
+	hl->suffix_len = strlen(hl->suffix);
+}
+
+static inline size_t
+hexlayout_width(
+	struct hexlayout const *hl
+) {
+	return hl->prefix_len + (2 * hl->z) + hl->suffix_len + hl->spaced;
+}
+
+extern size_t hexlayout_encode(struct hexlayout const *hl, char *cs, void const *p, size_t n);
+extern int    hexlayout_decode(struct hexlayout const *hl, void *p, size_t *np, char const *cs, size_t *mp, bool end);
+
+//------------------------------------------------------------------------------
+
+#endif//ndef HOL_HEXCODE_H__INCLUDED
+
+//------------------------------------------------------------------------------
+
+#ifdef HOL_HEXCODE_H__IMPLEMENTATION
+#undef HOL_HEXCODE_H__IMPLEMENTATION
+
+//------------------------------------------------------------------------------
+
+#include <hol/lebe.h>
+#include <hol/simd.h>
+#include <ctype.h>
+
+//------------------------------------------------------------------------------
+
+signed char const hexcode__value[256] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+static char const hexcode__digits[2][16] = {
+	{ '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' },
+	{ '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' },
+};
+
+// byte j of a value, in digit order
+static inline size_t
+hexcode__byte(
+	size_t z,
+	size_t j
+) {
+#if LEBE_BIG_ENDIAN_BYTE_ORDER
+	(void)z;
+	return j;
+#else
+	return z - 1 - j;
+#endif
+}
+
+#if defined(SIMD_SSSE3)
+
+// reverses the bytes of each value, so that digits come out in order
+static inline simd_ssse3 __m128i
+hexcode__order(
+	size_t z
+) {
+#if LEBE_BIG_ENDIAN_BYTE_ORDER
+	(void)z;
+	return _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+#else
+	switch(z) {
+	case 2:  return _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+	case 4:  return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	case 8:  return _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	default: return _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	}
+#endif
+}
+
+// nibble values of 16 digits, with a mask of those that are not digits
+static inline simd_ssse3 __m128i
+hexcode__nibbles(
+	__m128i  c,
+	unsigned *bad
+) {
+	__m128i const l = _mm_or_si128(c, _mm_set1_epi8(0x20));
+	__m128i const d = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+	__m128i const a = _mm_and_si128(_mm_cmpgt_epi8(l, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(l, _mm_set1_epi8('f' + 1)));
+	*bad = (unsigned)_mm_movemask_epi8(_mm_or_si128(d, a)) ^ 0xFFFFu;
+	return _mm_or_si128(
+		_mm_and_si128(d, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+		_mm_and_si128(a, _mm_sub_epi8(l, _mm_set1_epi8('a' - 10)))
+	);
+}
+
+// the kernels do whole vectors, and return the number of bytes done
+
+static simd_ssse3 size_t
+hexcode__span_ssse3(
+	char const *cs,
+	size_t      m
+) {
+	size_t i = 0;
+	for(; (i + 16) <= m; i += 16) {
+		unsigned bad;
+		hexcode__nibbles(_mm_loadu_si128((__m128i const *)(cs + i)), &bad);
+		if(bad) return i + tzcount(bad);
+	}
+	return i;
+}
+
+static simd_ssse3 size_t
+hexcode__encode_ssse3(
+	char          *cs,
+	uint8_t const *b,
+	size_t         m,
+	size_t         z,
+	char const    *x
+) {
+	__m128i const t = _mm_loadu_si128((__m128i const *)x);
+	__m128i const o = hexcode__order(z);
+	__m128i const f = _mm_set1_epi8(0x0F);
+	size_t        i = 0;
+	for(; (i + 16) <= m; i += 16) {
+		__m128i const v  = _mm_shuffle_epi8(_mm_loadu_si128((__m128i const *)(b + i)), o);
+		__m128i const hi = _mm_shuffle_epi8(t, _mm_and_si128(_mm_srli_epi16(v, 4), f));
+		__m128i const lo = _mm_shuffle_epi8(t, _mm_and_si128(v, f));
+		_mm_storeu_si128((__m128i *)(cs + (2 * i)),      _mm_unpacklo_epi8(hi, lo));
+		_mm_storeu_si128((__m128i *)(cs + (2 * i) + 16), _mm_unpackhi_epi8(hi, lo));
+	}
+	return i;
+}
+
+static simd_ssse3 size_t
+hexcode__decode_ssse3(
+	uint8_t    *b,
+	char const *cs,
+	size_t      m,
+	size_t      z
+) {
+	__m128i const o = hexcode__order(z);
+	__m128i const w = _mm_set1_epi16(0x0110);
+	size_t        i = 0;
+	for(; (i + 16) <= m; i += 16) {
+		unsigned bad0, bad1;
+		__m128i const v0 = hexcode__nibbles(_mm_loadu_si128((__m128i const *)(cs + (2 * i))),      &bad0);
+		__m128i const v1 = hexcode__nibbles(_mm_loadu_si128((__m128i const *)(cs + (2 * i) + 16)), &bad1);
+		if(bad0 | bad1) break;
+		// pairs of nibbles to bytes, as 16 * high + low
+		__m128i const v = _mm_packus_epi16(_mm_maddubs_epi16(v0, w), _mm_maddubs_epi16(v1, w));
+		_mm_storeu_si128((__m128i *)(b + i), _mm_shuffle_epi8(v, o));
+	}
+	return i;
+}
+
+#endif
+
+#if defined(SIMD_AVX2)
+
+static simd_avx2 size_t
+hexcode__encode_avx2(
+	char          *cs,
+	uint8_t const *b,
+	size_t         m,
+	size_t         z,
+	char const    *x
+) {
+	__m256i const t = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const *)x));
+	__m256i const o = _mm256_broadcastsi128_si256(hexcode__order(z));
+	__m256i const f = _mm256_set1_epi8(0x0F);
+	size_t        i = 0;
+	for(; (i + 32) <= m; i += 32) {
+		__m256i const v  = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i const *)(b + i)), o);
+		__m256i const hi = _mm256_shuffle_epi8(t, _mm256_and_si256(_mm256_srli_epi16(v, 4), f));
+		__m256i const lo = _mm256_shuffle_epi8(t, _mm256_and_si256(v, f));
+		__m256i const u0 = _mm256_unpacklo_epi8(hi, lo);
+		__m256i const u1 = _mm256_unpackhi_epi8(hi, lo);
+		_mm256_storeu_si256((__m256i *)(cs + (2 * i)),      _mm256_permute2x128_si256(u0, u1, 0x20));
+		_mm256_storeu_si256((__m256i *)(cs + (2 * i) + 32), _mm256_permute2x128_si256(u0, u1, 0x31));
+	}
+	return i;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+size_t
+hexspan(
+	char const *cs,
+	size_t      m
+) {
+	size_t i = 0;
+#if defined(SIMD_SSSE3)
+	if(has_ssse3()) i = hexcode__span_ssse3(cs, m);
+#endif
+	while((i < m) && (hexdigit(cs[i]) >= 0)) i++;
+	return i;
+}
+
+void
+hexencode(
+	char       *cs,
+	void const *p,
+	size_t      n,
+	size_t      z,
+	bool        upper
+) {
+	uint8_t const *b = p;
+	char    const *x = hexcode__digits[upper];
+	size_t  const  m = n * z;
+	size_t         i = 0;
+#if defined(SIMD_AVX2)
+	if(has_avx2()) i = hexcode__encode_avx2(cs, b, m, z, x);
+#endif
+#if defined(SIMD_SSSE3)
+	if(has_ssse3()) i += hexcode__encode_ssse3(cs + (2 * i), b + i, m - i, z, x);
+#endif
+	for(cs += 2 * i; i < m; i += z) {
+		for(size_t j = 0; j < z; j++) {
+			uint8_t const u = b[i + hexcode__byte(z, j)];
+			*cs++ = x[u >> 4];
+			*cs++ = x[u & 15];
+		}
+	}
+}
+
+size_t
+hexdecode(
+	void       *p,
+	char const *cs,
+	size_t      n,
+	size_t      z
+) {
+	uint8_t     *b = p;
+	size_t const m = n * z;
+	size_t       i = 0;
+#if defined(SIMD_SSSE3)
+	if(has_ssse3()) i = hexcode__decode_ssse3(b, cs, m, z);
+#endif
+	for(; i < m; i += z) {
+		for(size_t j = 0; j < z; j++) {
+			int const hi = hexdigit(cs[(2 * (i + j))]);
+			int const lo = hexdigit(cs[(2 * (i + j)) + 1]);
+			if((hi | lo) < 0) return i / z;
+			b[i + hexcode__byte(z, j)] = (uint8_t)((hi << 4) | lo);
+		}
+	}
+	return n;
+}
+
+//------------------------------------------------------------------------------
+
+size_t
+hexlayout_encode(
+	struct hexlayout const *hl,
+	char                   *cs,
+	void const             *p,
+	size_t                  n
+) {
+	size_t const z = hl->z;
+	size_t const d = 2 * z;
+
+	if(!hl->prefix_len && !hl->suffix_len && !hl->spaced) {
+		hexencode(cs, p, n, z, hl->upper);
+		return n * d;
+	}
+
+	char *const ct = cs;
+	char        t[2 * 1024];
+	for(uint8_t const *b = p; n > 0; ) {
+		size_t const k = (n < (sizeof(t) / d)) ? n : (sizeof(t) / d);
+		hexencode(t, b, k, z, hl->upper);
+		for(char const *s = t, *e = t + (k * d); s < e; s += d) {
+			memcpy(cs, hl->prefix, hl->prefix_len);
+			cs += hl->prefix_len;
+			switch(z) {
+			case 1:  memcpy(cs, s,  2); break;
+			case 2:  memcpy(cs, s,  4); break;
+			case 4:  memcpy(cs, s,  8); break;
+			default: memcpy(cs, s, 16); break;
+			}
+			cs += d;
+			memcpy(cs, hl->suffix, hl->suffix_len);
+			cs += hl->suffix_len;
+			if(hl->spaced) *cs++ = ' ';
+		}
+		b += k * z;
+		n -= k;
+	}
+	return (size_t)(cs - ct);
+}
+
+static inline void
+hexlayout__set(
+	void    *p,
+	size_t   z,
+	uint64_t u
+) {
+	switch(z) {
+	case 1:  *(uint8_t  *)p = (uint8_t )u; break;
+	case 2:  *(uint16_t *)p = (uint16_t)u; break;
+	case 4:  *(uint32_t *)p = (uint32_t)u; break;
+	default: *(uint64_t *)p = (uint64_t)u; break;
+	}
+}
+
+int
+hexlayout_decode(
+	struct hexlayout const *hl,
+	void                   *p,
+	size_t                 *np,
+	char const             *cs,
+	size_t                 *mp,
+	bool                    end
+) {
+	size_t const z = hl->z;
+	size_t const d = 2 * z;
+	size_t const n = *np;
+	size_t const m = *mp;
+	uint8_t     *b = p;
+	size_t       i = 0, k = 0;
+	int          r = 0;
+
+	// runs of digits, with no prefix to match, are decoded in bulk; unless a
+	// suffix that could be taken for digits has to be looked for
+	bool const bulk = !hl->prefix_len && (!hl->suffix_len || (hexdigit(*hl->suffix) < 0));
+
+	while(k < n) {
+		size_t j = i;
+		while((j < m) && isspace((unsigned char)cs[j])) j++;
+		i = j;
+		if(j == m) break;
+
+		if(hl->prefix_len) {
+			size_t const l = ((m - j) < hl->prefix_len) ? (m - j) : hl->prefix_len;
+			if(memcmp(cs + j, hl->prefix, l) != 0) {
+				r = -1;
+				break;
+			}
+			if(l < hl->prefix_len) break;
+			j += l;
+		} else if(((m - j) >= 2) && (cs[j] == '0') && ((cs[j + 1] | 0x20) == 'x')) {
+			// as with scanf, a 0x is taken as part of the number
+			if(((m - j) == 2) && !end) break;
+			if((m - j) > 2) j += 2 * (hexdigit(cs[j + 2]) >= 0);
+		}
+
+		size_t s = 0;
+		while(((j + s) < m) && (s < d) && (hexdigit(cs[j + s]) >= 0)) s++;
+		if(bulk && (s == d) && ((j + s) < m) && (hexdigit(cs[j + s]) >= 0)) {
+			size_t c = hexspan(cs + j, m - j) / d;
+			if(c > (n - k)) c = n - k;
+			hexdecode(b + (k * z), cs + j, c, z);
+			k += c;
+			i  = j + (c * d);
+			continue;
+		}
+		if(s == 0) {
+			if(j < m) r = -1;
+			break;
+		}
+		if((j + s == m) && (s < d) && !end) break;
+
+		uint64_t u = 0;
+		for(size_t e = j + s; j < e; j++) {
+			u = (u << 4) | (uint64_t)hexdigit(cs[j]);
+		}
+
+		if(hl->suffix_len) {
+			size_t const l = ((m - j) < hl->suffix_len) ? (m - j) : hl->suffix_len;
+			if((l < hl->suffix_len) && !end && (memcmp(cs + j, hl->suffix, l) == 0)) break;
+			if((l == hl->suffix_len) && (memcmp(cs + j, hl->suffix, l) == 0)) j += l;
+		}
+
+		hexlayout__set(b + (k * z), z, u);
+		k++;
+		i = j;
+	}
+
+	*np = k;
+	*mp = i;
+	return (k == n) ? 1 : r;
+}
+
+//------------------------------------------------------------------------------
+
+#endif//def HOL_HEXCODE_H__IMPLEMENTATION
@@ -27,6 +27,7 @@ SOFTWARE.
 //------------------------------------------------------------------------------
 
 #include <hol/nobreak.h>
+#include <hol/simd.h>
 #include <hol/xtdlib.h>
 #include <hol/xtdint.h>
 #include <hol/xtring.h>
@@ -41,15 +42,20 @@ SOFTWARE.
 #include <hol/utf8.h>
 #include <hol/array.h>
 #include <hol/hampt.h>
+#include <hol/hset.h>
+#include <hol/amqf.h>
 #include <hol/hash.h>
 #include <hol/spa.h>
 #include <hol/echof.h>
 #include <hol/optget.h>
 #include <hol/fnmatch.h>
 #include <hol/base64.h>
+#include <hol/hexcode.h>
+#include <hol/vlq.h>
 #include <hol/gen64.h>
 #include <hol/iasx.h>
 #include <hol/lebe.h>
+#include <hol/pipeline.h>
 
 //------------------------------------------------------------------------------
 
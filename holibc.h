@@ -40,12 +40,16 @@ SOFTWARE.
 #define HOL_UTF8_H__IMPLEMENTATION    (1)
 #define HOL_ARRAY_H__IMPLEMENTATION   (1)
 #define HOL_HAMPT_H__IMPLEMENTATION   (1)
+#define HOL_HSET_H__IMPLEMENTATION    (1)
+#define HOL_AMQF_H__IMPLEMENTATION    (1)
 #define HOL_HASH_H__IMPLEMENTATION    (1)
 #define HOL_SPA_H__IMPLEMENTATION     (1)
 #define HOL_ECHOF_H__IMPLEMENTATION   (1)
 #define HOL_OPTGET_H__IMPLEMENTATION  (1)
 #define HOL_FNMATCH_H__IMPLEMENTATION (1)
 #define HOL_BASE64_H__IMPLEMENTATION  (1)
+#define HOL_HEXCODE_H__IMPLEMENTATION (1)
+#define HOL_VLQ_H__IMPLEMENTATION     (1)
 #define HOL_GEN64_H__IMPLEMENTATION  (1)
 
 #include <hol/holib.h>
@@ -0,0 +1,338 @@
+#ifndef HOL_HSET_H__INCLUDED
+#define HOL_HSET_H__INCLUDED 1
+/*
+MIT License
+
+Copyright (c) 2023 Tristan Styles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <hol/xtdlib.h>
+
+//------------------------------------------------------------------------------
+
+// HSET: open-addressing hash set with per-slot control bytes, probed a group
+//       of control bytes at a time; a drop-in alternative to hampt for
+//       fixed-width hashes.
+
+struct hset_slot {
+	uint64_t hash;
+	void    *p;
+};
+
+struct hset {
+	size_t            n;
+	size_t            left;
+	size_t            mask;
+	uint8_t          *ctrl;
+	struct hset_slot *slot;
+};
+#define HSET(...)  { .n = 0, .left = 0, .mask = 0, .ctrl = NULL, .slot = NULL }
+
+extern void **hset_lookup(struct hset const *sp, uint64_t h);
+extern void **hset_insert(struct hset       *sp, uint64_t h);
+extern void   hset_remove(struct hset       *sp, uint64_t h);
+extern int    hset_walk  (struct hset       *sp, int (*cb)(void *, void *, int), void *c, int d);
+
+static inline void
+hset_clear(
+	struct hset *sp,
+	void       (*cb)(void *)
+) {
+	extern void hset_clear__with_callback(struct hset *sp, void (*cb)(void *));
+	if(sp->ctrl) {
+		if(cb) hset_clear__with_callback(sp, cb);
+		free(sp->ctrl);
+		free(sp->slot);
+		*sp = (struct hset)HSET();
+	}
+}
+#define hset_clear(hset_clear__sp,...)  (hset_clear)(hset_clear__sp,__VA_ARGS__+0)
+
+//------------------------------------------------------------------------------
+
+#endif//ndef HOL_HSET_H__INCLUDED
+
+//------------------------------------------------------------------------------
+
+#ifdef HOL_HSET_H__IMPLEMENTATION
+#undef HOL_HSET_H__IMPLEMENTATION
+
+//------------------------------------------------------------------------------
+
+#include <hol/lebe.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+
+enum {
+	HSET_EMPTY   = 0x80,
+	HSET_DELETED = 0xFE,
+#if defined(__SSE2__)
+	HSET_GROUP   = 16,
+	HSET_SHIFT   = 0,
+#else
+	HSET_GROUP   = 8,
+	HSET_SHIFT   = 3,
+#endif
+};
+
+static inline uint64_t hset__mix(uint64_t h) { return h * UINT64_C(0x9E3779B97F4A7C15); }
+static inline uint8_t  hset__h2 (uint64_t x) { return (uint8_t)(x >> 57); }
+static inline size_t   hset__h1 (uint64_t x) { return (size_t)x; }
+
+#if defined(__SSE2__)
+
+typedef __m128i  hset__group;
+typedef uint32_t hset__bits;
+
+static inline hset__group hset__load(uint8_t const *p) {
+	return _mm_loadu_si128((__m128i const *)p);
+}
+static inline hset__bits hset__match(hset__group g, uint8_t h2) {
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)h2)));
+}
+static inline hset__bits hset__match_empty(hset__group g) {
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)HSET_EMPTY)));
+}
+static inline hset__bits hset__match_free(hset__group g) {
+	return (uint32_t)_mm_movemask_epi8(g);
+}
+static inline hset__bits hset__match_full(hset__group g) {
+	return (uint32_t)_mm_movemask_epi8(g) ^ 0xFFFFu;
+}
+static inline int        hset__first(hset__bits m) { return tzcount(m) >> HSET_SHIFT; }
+static inline hset__bits hset__next (hset__bits m) { return m & (m - 1); }
+
+#else
+
+typedef uint64_t hset__group;
+typedef uint64_t hset__bits;
+
+#define HSET__LSBS  UINT64_C(0x0101010101010101)
+#define HSET__MSBS  UINT64_C(0x8080808080808080)
+
+static inline hset__group hset__load(uint8_t const *p) {
+	uint64_t g;
+	memcpy(&g, p, sizeof(g));
+	return leswapbytes(g);
+}
+static inline hset__bits hset__match(hset__group g, uint8_t h2) {
+	// may report false positives, which are rejected by the hash comparison
+	uint64_t const x = g ^ (HSET__LSBS * h2);
+	return (x - HSET__LSBS) & ~x & HSET__MSBS;
+}
+static inline hset__bits hset__match_empty(hset__group g) {
+	return g & ~(g << 6) & HSET__MSBS;
+}
+static inline hset__bits hset__match_free(hset__group g) {
+	return g & HSET__MSBS;
+}
+static inline hset__bits hset__match_full(hset__group g) {
+	return ~g & HSET__MSBS;
+}
+static inline int        hset__first(hset__bits m) { return tzcount(m) >> HSET_SHIFT; }
+static inline hset__bits hset__next (hset__bits m) { return m & (m - 1); }
+
+#endif
+
+//------------------------------------------------------------------------------
+
+static inline size_t
+hset__capacity(
+	struct hset const *sp
+) {
+	return sp->ctrl ? sp->mask + 1 : 0;
+}
+
+static inline size_t
+hset__groups_mask(
+	struct hset const *sp
+) {
+	return (sp->mask + 1) / HSET_GROUP - 1;
+}
+
+static struct hset_slot *
+hset__find(
+	struct hset const *sp,
+	uint64_t           h
+) {
+	if(sp->ctrl) {
+		uint64_t const x = hset__mix(h);
+		uint8_t  const t = hset__h2(x);
+		size_t   const m = hset__groups_mask(sp);
+		size_t         g = hset__h1(x) & m;
+		for(size_t i = 1; ; g = (g + i++) & m) {
+			size_t      const o = g * HSET_GROUP;
+			hset__group const q = hset__load(sp->ctrl + o);
+			for(hset__bits b = hset__match(q, t); b; b = hset__next(b)) {
+				struct hset_slot *s = &sp->slot[o + hset__first(b)];
+				if(s->hash == h) return s;
+			}
+			if(hset__match_empty(q)) break;
+		}
+	}
+	return NULL;
+}
+
+static size_t
+hset__find_free(
+	struct hset const *sp,
+	uint64_t           x
+) {
+	size_t const m = hset__groups_mask(sp);
+	size_t       g = hset__h1(x) & m;
+	for(size_t i = 1; ; g = (g + i++) & m) {
+		size_t      const o = g * HSET_GROUP;
+		hset__group const q = hset__load(sp->ctrl + o);
+		hset__bits b = hset__match_free(q);
+		if(b) return o + hset__first(b);
+	}
+}
+
+static bool
+hset__resize(
+	struct hset *sp,
+	size_t       z
+) {
+	uint8_t          *ctrl = malloc(z);
+	struct hset_slot *slot = malloc(z * sizeof(*slot));
+	if(unlikely(!ctrl || !slot)) {
+		free(ctrl);
+		free(slot);
+		return false;
+	}
+	memset(ctrl, HSET_EMPTY, z);
+
+	struct hset t = {
+		.n    = sp->n,
+		.left = ((z / 8) * 7) - sp->n,
+		.mask = z - 1,
+		.ctrl = ctrl,
+		.slot = slot,
+	};
+	for(size_t i = 0, n = hset__capacity(sp); i < n; i++) {
+		if(!(sp->ctrl[i] & HSET_EMPTY)) {
+			uint64_t const x = hset__mix(sp->slot[i].hash);
+			size_t   const j = hset__find_free(&t, x);
+			t.ctrl[j] = hset__h2(x);
+			t.slot[j] = sp->slot[i];
+		}
+	}
+	free(sp->ctrl);
+	free(sp->slot);
+	*sp = t;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+
+void
+hset_clear__with_callback(
+	struct hset *sp,
+	void       (*cb)(void *)
+) {
+	for(size_t i = 0, n = hset__capacity(sp); i < n; i++) {
+		if(!(sp->ctrl[i] & HSET_EMPTY)) {
+			cb(sp->slot[i].p);
+		}
+	}
+}
+
+void **
+hset_lookup(
+	struct hset const *sp,
+	uint64_t           h
+) {
+	struct hset_slot *s = hset__find(sp, h);
+	return s ? &s->p : NULL;
+}
+
+void **
+hset_insert(
+	struct hset *sp,
+	uint64_t     h
+) {
+	struct hset_slot *s = hset__find(sp, h);
+	if(s) return &s->p;
+
+	uint64_t const x = hset__mix(h);
+	size_t         i = sp->ctrl ? hset__find_free(sp, x) : 0;
+	if(!sp->ctrl || (!sp->left && (sp->ctrl[i] == HSET_EMPTY))) {
+		size_t z = hset__capacity(sp);
+		// grow when more than half full, otherwise reclaim deleted slots
+		z = (z == 0) ? HSET_GROUP : ((sp->n > (z / 2)) ? (z * 2) : z);
+		if(unlikely(!hset__resize(sp, z))) return NULL;
+		i = hset__find_free(sp, x);
+	}
+
+	sp->left -= (sp->ctrl[i] == HSET_EMPTY);
+	sp->ctrl[i] = hset__h2(x);
+	sp->n++;
+	s = &sp->slot[i];
+	s->hash = h;
+	s->p    = NULL;
+	return &s->p;
+}
+
+void
+hset_remove(
+	struct hset *sp,
+	uint64_t     h
+) {
+	struct hset_slot *s = hset__find(sp, h);
+	if(s) {
+		size_t      const i = s - sp->slot;
+		size_t      const o = i - (i % HSET_GROUP);
+		hset__group const q = hset__load(sp->ctrl + o);
+		// a group that has never been full can not have been probed past
+		if(hset__match_empty(q)) {
+			sp->ctrl[i] = HSET_EMPTY;
+			sp->left++;
+		} else {
+			sp->ctrl[i] = HSET_DELETED;
+		}
+		sp->n--;
+	}
+}
+
+int
+hset_walk(
+	struct hset *sp,
+	int        (*cb)(void *, void *, int),
+	void        *c,
+	int          d
+) {
+	int rc = 0;
+	for(size_t o = 0, n = hset__capacity(sp); o < n; o += HSET_GROUP) {
+		hset__group const q = hset__load(sp->ctrl + o);
+		for(hset__bits b = hset__match_full(q); b; b = hset__next(b)) {
+			if((rc = cb(sp->slot[o + hset__first(b)].p, c, d)) != 0) return rc;
+		}
+	}
+	return rc;
+}
+
+//------------------------------------------------------------------------------
+
+#endif//def HOL_HSET_H__IMPLEMENTATION
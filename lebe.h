@@ -26,7 +26,10 @@ SOFTWARE.
 
 //------------------------------------------------------------------------------
 
+#include <stddef.h>
 #include <stdint.h>
+#include <hol/simd.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -236,6 +239,135 @@ static inline void stzbe(void const *q, void *p) {
 
 //------------------------------------------------------------------------------
 
+// arrays of n values, swapped a vector at a time with SSSE3 or AVX2, and only
+// copied where the byte order is native; q and p may be the same array, but
+// must not otherwise overlap
+
+#if defined(SIMD_SSSE3)
+static inline simd_ssse3 __m128i
+lebe__swapmask(
+	size_t z
+) {
+	switch(z) {
+	case 2: return _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+	case 4: return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	default:
+	case 8: return _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	}
+}
+
+static inline simd_ssse3 size_t
+lebe__swapbytes_ssse3(
+	uint8_t       *d,
+	uint8_t const *s,
+	size_t         m,
+	size_t         z
+) {
+	__m128i const k = lebe__swapmask(z);
+	size_t        i = 0;
+	for(; (i + 16) <= m; i += 16) {
+		__m128i const v = _mm_loadu_si128((__m128i const *)(s + i));
+		_mm_storeu_si128((__m128i *)(d + i), _mm_shuffle_epi8(v, k));
+	}
+	return i;
+}
+#endif
+
+#if defined(SIMD_AVX2)
+static inline simd_avx2 size_t
+lebe__swapbytes_avx2(
+	uint8_t       *d,
+	uint8_t const *s,
+	size_t         m,
+	size_t         z
+) {
+	__m256i const k = _mm256_broadcastsi128_si256(lebe__swapmask(z));
+	size_t        i = 0;
+	for(; (i + 32) <= m; i += 32) {
+		__m256i const v = _mm256_loadu_si256((__m256i const *)(s + i));
+		_mm256_storeu_si256((__m256i *)(d + i), _mm256_shuffle_epi8(v, k));
+	}
+	return i;
+}
+#endif
+
+static inline void
+lebe__swapbytesv(
+	void       *q,
+	void const *p,
+	size_t      n,
+	size_t      z
+) {
+	uint8_t       *d = (uint8_t *)q;
+	uint8_t const *s = (uint8_t const *)p;
+	size_t         i = 0, m = n * z;
+#if defined(SIMD_AVX2)
+	if(has_avx2()) i = lebe__swapbytes_avx2(d, s, m, z);
+#endif
+#if defined(SIMD_SSSE3)
+	if(has_ssse3()) i += lebe__swapbytes_ssse3(d + i, s + i, m - i, z);
+#endif
+	for(; i < m; i += z) {
+		switch(z) {
+		case 2: { uint16_t u; memcpy(&u, s + i, z); u = swapbytes16(u); memcpy(d + i, &u, z); } break;
+		case 4: { uint32_t u; memcpy(&u, s + i, z); u = swapbytes32(u); memcpy(d + i, &u, z); } break;
+		case 8: { uint64_t u; memcpy(&u, s + i, z); u = swapbytes64(u); memcpy(d + i, &u, z); } break;
+		}
+	}
+}
+
+static inline void swapbytes16v(void *q, void const *p, size_t n) {
+	lebe__swapbytesv(q, p, n, sizeof(uint16_t));
+}
+static inline void swapbytes32v(void *q, void const *p, size_t n) {
+	lebe__swapbytesv(q, p, n, sizeof(uint32_t));
+}
+static inline void swapbytes64v(void *q, void const *p, size_t n) {
+	lebe__swapbytesv(q, p, n, sizeof(uint64_t));
+}
+
+static inline void
+lebe__copyv(
+	void       *q,
+	void const *p,
+	size_t      n
+) {
+	if(q != p) memcpy(q, p, n);
+}
+
+#if LEBE_BIG_ENDIAN_BYTE_ORDER
+#	define LEBE__LEV(LEBE__LEV__bits,LEBE__LEV__q,LEBE__LEV__p,LEBE__LEV__n)  \
+		swapbytes##LEBE__LEV__bits##v(LEBE__LEV__q, LEBE__LEV__p, LEBE__LEV__n)
+#	define LEBE__BEV(LEBE__BEV__bits,LEBE__BEV__q,LEBE__BEV__p,LEBE__BEV__n)  \
+		lebe__copyv(LEBE__BEV__q, LEBE__BEV__p, (LEBE__BEV__n) * ((LEBE__BEV__bits) / 8))
+#else
+#	define LEBE__LEV(LEBE__LEV__bits,LEBE__LEV__q,LEBE__LEV__p,LEBE__LEV__n)  \
+		lebe__copyv(LEBE__LEV__q, LEBE__LEV__p, (LEBE__LEV__n) * ((LEBE__LEV__bits) / 8))
+#	define LEBE__BEV(LEBE__BEV__bits,LEBE__BEV__q,LEBE__BEV__p,LEBE__BEV__n)  \
+		swapbytes##LEBE__BEV__bits##v(LEBE__BEV__q, LEBE__BEV__p, LEBE__BEV__n)
+#endif
+#define LEBE__ARRAY(LEBE__ARRAY__bits)  \
+static inline void ldu##LEBE__ARRAY__bits##le_array(void const *p, void *q, size_t n) { \
+	LEBE__LEV(LEBE__ARRAY__bits, q, p, n); \
+} \
+static inline void stu##LEBE__ARRAY__bits##le_array(void const *q, void *p, size_t n) { \
+	LEBE__LEV(LEBE__ARRAY__bits, p, q, n); \
+} \
+static inline void ldu##LEBE__ARRAY__bits##be_array(void const *p, void *q, size_t n) { \
+	LEBE__BEV(LEBE__ARRAY__bits, q, p, n); \
+} \
+static inline void stu##LEBE__ARRAY__bits##be_array(void const *q, void *p, size_t n) { \
+	LEBE__BEV(LEBE__ARRAY__bits, p, q, n); \
+}
+LEBE__ARRAY(16)
+LEBE__ARRAY(32)
+LEBE__ARRAY(64)
+#undef LEBE__ARRAY
+#undef LEBE__BEV
+#undef LEBE__LEV
+
+//------------------------------------------------------------------------------
+
 #ifdef __cplusplus
 }
 #endif
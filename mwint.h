@@ -166,6 +166,18 @@ static inline void mwror(size_t z, uint64_t v[z], unsigned n) {
 	mwrol(z, v, -n);
 }
 
+// divides v by d in place, d must be less than 2^32, returns the remainder
+static inline uint64_t mwdivu(size_t z, uint64_t v[z], uint64_t d) {
+	uint64_t r = 0;
+	for(size_t i = z; i-- > 0; ) {
+		uint64_t const h = (r << 32) | (v[i] >> 32);
+		uint64_t const l = ((h % d) << 32) | (v[i] & UINT32_MAX);
+		r    = l % d;
+		v[i] = ((h / d) << 32) | (l / d);
+	}
+	return r;
+}
+
 //------------------------------------------------------------------------------
 
 #define MWINT_BITS(MWINT__Nbits)  (((MWINT__Nbits) + 63) & ~64)
@@ -188,4 +200,81 @@ static inline uint##MWINT__Nbits##_t shr##MWINT__Nbits(uint##MWINT__Nbits##_t v,
 static inline uint##MWINT__Nbits##_t rol##MWINT__Nbits(uint##MWINT__Nbits##_t v, unsigned n) { mwrol(MWINT_WORDS(MWINT__Nbits), v.u, n); return v; } \
 static inline uint##MWINT__Nbits##_t ror##MWINT__Nbits(uint##MWINT__Nbits##_t v, unsigned n) { mwror(MWINT_WORDS(MWINT__Nbits), v.u, n); return v; }
 
+//------------------------------------------------------------------------------
+
+extern int mwgenperm(size_t z, uint64_t const p[z], size_t n, size_t i[n]);
+
+//------------------------------------------------------------------------------
+
 #endif//ndef HOL_MWINT_H
+
+//------------------------------------------------------------------------------
+
+#ifdef HOL_MWINT_H__IMPLEMENTATION
+#undef HOL_MWINT_H__IMPLEMENTATION
+
+//------------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <errno.h>
+
+//------------------------------------------------------------------------------
+
+// unranks as genperm, but for ranks of any size; the free slots are counted
+// in a Fenwick tree, so each element is placed in O(log n)
+int
+mwgenperm(
+	size_t         z,
+	uint64_t const p[z],
+	size_t         n,
+	size_t         i[n]
+) {
+	if(n > UINT32_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+	uint64_t *const v = malloc((z * sizeof(*v)) + ((n + 1) * sizeof(size_t)));
+	if(!v) {
+		return -1;
+	}
+	size_t *const t = (size_t *)(v + z);
+
+	for(size_t y = 0; y < z; y++) {
+		v[y] = p[y];
+	}
+	for(; (z > 0) && !v[z-1]; z--)
+		;
+	size_t b = 1;
+	for(size_t y = 1; y <= n; y++) {
+		t[y] = y & -y;
+		if((b << 1) <= n) b <<= 1;
+		i[y-1] = SIZE_MAX;
+	}
+
+	for(size_t k = n; (z > 0) && (k > 0); ) {
+		size_t x = (k - 1) - mwdivu(z, v, k);
+		size_t y = 0;
+		for(size_t s = b; s > 0; s >>= 1) {
+			if(((y + s) <= n) && (t[y + s] <= x)) {
+				y += s;
+				x -= t[y];
+			}
+		}
+		i[y] = --k;
+		for(y++; y <= n; y += y & -y) {
+			t[y]--;
+		}
+		for(; (z > 0) && !v[z-1]; z--)
+			;
+	}
+	for(size_t y = 0, e = 0; y < n; y++) {
+		if(i[y] == SIZE_MAX) i[y] = e++;
+	}
+
+	free(v);
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+
+#endif//def HOL_MWINT_H__IMPLEMENTATION
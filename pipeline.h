@@ -0,0 +1,277 @@
+#ifndef HOL_PIPELINE_H__INCLUDED
+#define HOL_PIPELINE_H__INCLUDED  1
+/*
+MIT License
+
+Copyright (c) 2023 Tristan Styles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//------------------------------------------------------------------------------
+
+#include <hol/xtdlib.h>
+
+//------------------------------------------------------------------------------
+
+// PIPELINE: a reader thread, a transform on the calling thread, and a writer
+//           thread, passing large blocks around a bounded ring; each slot has
+//           an input buffer of in_size bytes and an output buffer of out_size
+//           bytes, so reading and writing overlap the transform.
+//
+//           read fills up to in_size bytes, and returns the number read, a
+//           short read ends the input; transform converts n input bytes,
+//           last set for the final block (which may be empty), and returns
+//           the number of output bytes; write returns false on failure. read
+//           and transform return SIZE_MAX on failure. depth is the number of
+//           slots, with 1 every block goes through each stage in turn; set
+//           clear to have the buffers zeroed before they are freed. pipeline_run
+//           returns 0, or -1 with errno set by the stage that failed.
+//
+//           the implementation needs pthreads, so holibc.h leaves it out; a
+//           tool that runs a pipeline defines HOL_PIPELINE_H__IMPLEMENTATION
+//           before including holibc.h, and links with -pthread.
+
+struct pipeline {
+	size_t   in_size;
+	size_t   out_size;
+	size_t   depth;
+	bool     clear;
+	size_t (*read)     (void *ctx, void *b, size_t z);
+	size_t (*transform)(void *ctx, void *out, void *in, size_t n, bool last);
+	bool   (*write)    (void *ctx, void *b, size_t n);
+	void    *ctx;
+};
+
+extern int pipeline_run(struct pipeline const *pp);
+
+//------------------------------------------------------------------------------
+
+#endif//ndef HOL_PIPELINE_H__INCLUDED
+
+//------------------------------------------------------------------------------
+
+#ifdef HOL_PIPELINE_H__IMPLEMENTATION
+#undef HOL_PIPELINE_H__IMPLEMENTATION
+
+//------------------------------------------------------------------------------
+
+#include <pthread.h>
+#include <errno.h>
+
+//------------------------------------------------------------------------------
+
+struct pipeline__slot {
+	void  *in;
+	void  *out;
+	size_t n;
+	bool   last;
+};
+
+struct pipeline__state {
+	struct pipeline const *pp;
+	struct pipeline__slot *slot;
+	pthread_mutex_t        lock;
+	pthread_cond_t         cond;
+	uint64_t               read;
+	uint64_t               transformed;
+	uint64_t               written;
+	bool                   failed;
+	int                    error;
+};
+
+static void
+pipeline__fail(
+	struct pipeline__state *sp
+) {
+	pthread_mutex_lock(&sp->lock);
+	if(!sp->failed) {
+		sp->failed = true;
+		sp->error  = errno;
+	}
+	pthread_cond_broadcast(&sp->cond);
+	pthread_mutex_unlock(&sp->lock);
+}
+
+// waits until lo <= *ahead - *behind < hi, returns false on failure
+static bool
+pipeline__wait(
+	struct pipeline__state *sp,
+	uint64_t const         *ahead,
+	uint64_t const         *behind,
+	uint64_t                lo,
+	uint64_t                hi
+) {
+	pthread_mutex_lock(&sp->lock);
+	while(!sp->failed && (((*ahead - *behind) < lo) || ((*ahead - *behind) >= hi))) {
+		pthread_cond_wait(&sp->cond, &sp->lock);
+	}
+	bool const ok = !sp->failed;
+	pthread_mutex_unlock(&sp->lock);
+	return ok;
+}
+
+static void
+pipeline__advance(
+	struct pipeline__state *sp,
+	uint64_t               *count
+) {
+	pthread_mutex_lock(&sp->lock);
+	++*count;
+	pthread_cond_broadcast(&sp->cond);
+	pthread_mutex_unlock(&sp->lock);
+}
+
+static bool
+pipeline__read(
+	struct pipeline__state *sp
+) {
+	struct pipeline const *pp = sp->pp;
+	struct pipeline__slot *s  = &sp->slot[sp->read % pp->depth];
+	s->n = pp->read(pp->ctx, s->in, pp->in_size);
+	if(s->n == SIZE_MAX) {
+		pipeline__fail(sp);
+		return false;
+	}
+	bool const more = (s->n == pp->in_size);
+	s->last = !more;
+	pipeline__advance(sp, &sp->read);
+	return more;
+}
+
+static bool
+pipeline__transform(
+	struct pipeline__state *sp
+) {
+	struct pipeline const *pp = sp->pp;
+	struct pipeline__slot *s  = &sp->slot[sp->transformed % pp->depth];
+	s->n = pp->transform(pp->ctx, s->out, s->in, s->n, s->last);
+	if(s->n == SIZE_MAX) {
+		pipeline__fail(sp);
+		return false;
+	}
+	bool const more = !s->last;
+	pipeline__advance(sp, &sp->transformed);
+	return more;
+}
+
+static bool
+pipeline__write(
+	struct pipeline__state *sp
+) {
+	struct pipeline const *pp = sp->pp;
+	struct pipeline__slot *s  = &sp->slot[sp->written % pp->depth];
+	if((s->n > 0) && !pp->write(pp->ctx, s->out, s->n)) {
+		pipeline__fail(sp);
+		return false;
+	}
+	bool const more = !s->last;
+	pipeline__advance(sp, &sp->written);
+	return more;
+}
+
+static void *
+pipeline__reader(
+	void *arg
+) {
+	struct pipeline__state *sp = arg;
+	while(pipeline__wait(sp, &sp->read, &sp->written, 0, sp->pp->depth) && pipeline__read(sp))
+		;
+	return NULL;
+}
+
+static void *
+pipeline__writer(
+	void *arg
+) {
+	struct pipeline__state *sp = arg;
+	while(pipeline__wait(sp, &sp->transformed, &sp->written, 1, UINT64_MAX) && pipeline__write(sp))
+		;
+	return NULL;
+}
+
+int
+pipeline_run(
+	struct pipeline const *pp
+) {
+	if(pp->depth == 0) {
+		errno = EINVAL;
+		return -1;
+	}
+	struct pipeline__state s = {
+		.pp   = pp,
+		.slot = calloc(pp->depth, sizeof(*s.slot)),
+	};
+	char *b = malloc(pp->depth * (pp->in_size + pp->out_size));
+	if(!s.slot || !b) {
+		free(s.slot);
+		free(b);
+		return -1;
+	}
+	for(size_t i = 0; i < pp->depth; i++) {
+		s.slot[i].in  = b + (i * (pp->in_size + pp->out_size));
+		s.slot[i].out = (char *)s.slot[i].in + pp->in_size;
+	}
+	pthread_mutex_init(&s.lock, NULL);
+	pthread_cond_init(&s.cond, NULL);
+
+	pthread_t  reader, writer;
+	bool const reading = (pp->depth > 1) && (pthread_create(&reader, NULL, pipeline__reader, &s) == 0);
+	bool const writing = reading && (pthread_create(&writer, NULL, pipeline__writer, &s) == 0);
+	if(writing) {
+		while(pipeline__wait(&s, &s.read, &s.transformed, 1, UINT64_MAX) && pipeline__transform(&s))
+			;
+		pthread_join(writer, NULL);
+	} else if(reading) {
+		// without a writer each block is written as soon as it is transformed
+		for(bool more = true; more && pipeline__wait(&s, &s.read, &s.transformed, 1, UINT64_MAX); ) {
+			uint64_t const n = s.transformed;
+			pipeline__transform(&s);
+			more = (s.transformed != n) && pipeline__write(&s);
+		}
+	}
+	if(reading) {
+		pthread_join(reader, NULL);
+	} else {
+		// without threads each block goes through every stage in turn
+		for(bool more = true; more && !s.failed; ) {
+			more = pipeline__read(&s);
+			if(!s.failed) pipeline__transform(&s);
+			if(!s.failed) pipeline__write(&s);
+		}
+	}
+
+	pthread_cond_destroy(&s.cond);
+	pthread_mutex_destroy(&s.lock);
+	if(pp->clear) {
+		for(volatile char *volatile v = b, *e = v + (pp->depth * (pp->in_size + pp->out_size)); v < e; *v++ = 0)
+			;
+	}
+	free(s.slot);
+	free(b);
+	if(s.failed) {
+		errno = s.error;
+		return -1;
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+
+#endif//def HOL_PIPELINE_H__IMPLEMENTATION
@@ -0,0 +1,70 @@
+#ifndef HOL_SIMD_H__INCLUDED
+#define HOL_SIMD_H__INCLUDED  1
+/*
+MIT License
+
+Copyright (c) 2023 Tristan Styles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//------------------------------------------------------------------------------
+
+// SIMD: the x86 vector kernels are compiled whether or not the build enables
+//       SSSE3 or AVX2; with GCC or Clang on x86-64 a kernel the build does not
+//       enable gets a target attribute, and is only called when cpuid says
+//       the processor has it. A build with -mssse3 or -mavx2 calls them
+//       unconditionally; define SIMD_NO_DISPATCH to use only what the build
+//       enables.
+//
+//       SIMD_SSSE3, SIMD_AVX2      defined when the kernels can be compiled
+//       simd_ssse3, simd_avx2      attributes for a kernel and its helpers
+//       has_ssse3(), has_avx2()    whether the kernels may be called
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(SIMD_NO_DISPATCH)
+#	define SIMD__DISPATCH  (1)
+#endif
+
+#if defined(__SSSE3__)
+#	define SIMD_SSSE3   (1)
+#	define simd_ssse3
+#	define has_ssse3()  (1)
+#elif defined(SIMD__DISPATCH)
+#	define SIMD_SSSE3   (1)
+#	define simd_ssse3   __attribute__((target("ssse3")))
+#	define has_ssse3()  __builtin_cpu_supports("ssse3")
+#endif
+
+#if defined(__AVX2__)
+#	define SIMD_AVX2    (1)
+#	define simd_avx2
+#	define has_avx2()   (1)
+#elif defined(SIMD__DISPATCH)
+#	define SIMD_AVX2    (1)
+#	define simd_avx2    __attribute__((target("avx2")))
+#	define has_avx2()   __builtin_cpu_supports("avx2")
+#endif
+
+#if defined(SIMD_SSSE3) || defined(SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+
+#endif//ndef HOL_SIMD_H__INCLUDED
@@ -0,0 +1,673 @@
+#ifndef HOL_VLQ_H__INCLUDED
+#define HOL_VLQ_H__INCLUDED  1
+/*
+MIT License
+
+Copyright (c) 2024 Tristan Styles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+//------------------------------------------------------------------------------
+
+#include <hol/xtdlib.h>
+
+//------------------------------------------------------------------------------
+
+// VLQ: variable length quantities, 7 bits to a byte, with the high bit set on
+//      all but the last byte of a value; big-endian puts the most significant
+//      group first, little-endian (LEB128) the least significant.
+
+#define VLQ_MAX_LEN  (10)
+
+static inline size_t
+vlqlen(
+	uint64_t u
+) {
+	return ((size_t)msbit(u | 1) + 6) / 7;
+}
+
+// encoding writes up to 8 bytes past the end of each value, so p must have
+// room for VLQ_MAX_LEN bytes a value; returns the number of bytes written
+extern size_t vlqle_encode(void *p, uint64_t const *u, size_t n);
+extern size_t vlqbe_encode(void *p, uint64_t const *u, size_t n);
+
+// decodes up to *np values, leaving any partial value at the end of the bytes,
+// and returns the number of bytes used; a value of more than 64 bits stops
+// decoding, with errno set to EILSEQ
+extern size_t vlqle_decode(uint64_t *u, size_t *np, void const *p, size_t m);
+extern size_t vlqbe_decode(uint64_t *u, size_t *np, void const *p, size_t m);
+
+//------------------------------------------------------------------------------
+
+#endif//ndef HOL_VLQ_H__INCLUDED
+
+//------------------------------------------------------------------------------
+
+#ifdef HOL_VLQ_H__IMPLEMENTATION
+#undef HOL_VLQ_H__IMPLEMENTATION
+
+//------------------------------------------------------------------------------
+
+#include <hol/lebe.h>
+#include <errno.h>
+#include <hol/simd.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+
+#define VLQ__GROUPS  UINT64_C(0x7F7F7F7F7F7F7F7F)
+#define VLQ__HIGHS   UINT64_C(0x8080808080808080)
+
+static inline uint64_t
+vlq__load(
+	uint8_t const *p
+) {
+	uint64_t w;
+	memcpy(&w, p, sizeof(w));
+	return leswapbytes(w);
+}
+
+static inline void
+vlq__store(
+	uint8_t *p,
+	uint64_t w
+) {
+	w = leswapbytes(w);
+	memcpy(p, &w, sizeof(w));
+}
+
+static inline uint64_t
+vlq__bytes(
+	size_t n
+) {
+	return (n < 8) ? ~(~UINT64_C(0) << (8 * n)) : ~UINT64_C(0);
+}
+
+// the 7 bit groups of up to 8 bytes, least significant first, packed together
+// and spread apart again; after the bits are shifted into place a pair, a
+// quad, then an octet at a time
+
+static inline uint64_t
+vlq__pack(
+	uint64_t w
+) {
+	w &= VLQ__GROUPS;
+	w  = (w & UINT64_C(0x007F007F007F007F)) | ((w & UINT64_C(0x7F007F007F007F00)) >> 1);
+	w  = (w & UINT64_C(0x00003FFF00003FFF)) | ((w & UINT64_C(0x3FFF00003FFF0000)) >> 2);
+	w  = (w & UINT64_C(0x000000000FFFFFFF)) | ((w & UINT64_C(0x0FFFFFFF00000000)) >> 4);
+	return w;
+}
+
+static inline uint64_t
+vlq__spread(
+	uint64_t u
+) {
+	u  = (u & UINT64_C(0x000000000FFFFFFF)) | ((u & UINT64_C(0x00FFFFFFF0000000)) << 4);
+	u  = (u & UINT64_C(0x00003FFF00003FFF)) | ((u & UINT64_C(0x0FFFC0000FFFC000)) << 2);
+	u  = (u & UINT64_C(0x007F007F007F007F)) | ((u & UINT64_C(0x3F803F803F803F80)) << 1);
+	return u;
+}
+
+// a bit for each byte of 16 that has the high bit set
+static inline unsigned
+vlq__mask16(
+	uint8_t const *p
+) {
+#if defined(__SSE2__)
+	return (unsigned)_mm_movemask_epi8(_mm_loadu_si128((__m128i const *)p));
+#else
+	uint64_t const m = UINT64_C(0x0102040810204080);
+	uint64_t const a = ((vlq__load(p    ) & VLQ__HIGHS) >> 7) * m;
+	uint64_t const b = ((vlq__load(p + 8) & VLQ__HIGHS) >> 7) * m;
+	return (unsigned)(a >> 56) | ((unsigned)(b >> 56) << 8);
+#endif
+}
+
+// 16 values of 1 byte
+static inline void
+vlq__widen16(
+	uint64_t      *u,
+	uint8_t const *p
+) {
+#if defined(__SSE2__)
+	__m128i const z  = _mm_setzero_si128();
+	__m128i const b  = _mm_loadu_si128((__m128i const *)p);
+	__m128i const h0 = _mm_unpacklo_epi8(b, z);
+	__m128i const h1 = _mm_unpackhi_epi8(b, z);
+	__m128i const w[4] = {
+		_mm_unpacklo_epi16(h0, z), _mm_unpackhi_epi16(h0, z),
+		_mm_unpacklo_epi16(h1, z), _mm_unpackhi_epi16(h1, z),
+	};
+	for(int i = 0; i < 4; i++) {
+		_mm_storeu_si128((__m128i *)(u + (4 * i)    ), _mm_unpacklo_epi32(w[i], z));
+		_mm_storeu_si128((__m128i *)(u + (4 * i) + 2), _mm_unpackhi_epi32(w[i], z));
+	}
+#else
+	for(int i = 0; i < 16; i++) {
+		u[i] = p[i];
+	}
+#endif
+}
+
+#if defined(SIMD_SSSE3)
+
+// values of 1 or 2 bytes, as many as start in the first 8 of 16 bytes, are
+// shuffled into 16 bit lanes by the pattern of their continuation bits
+struct vlq__short {
+	uint8_t shuffle[16];
+	uint8_t n;
+	uint8_t len;
+};
+
+static struct vlq__short const vlq__short[256] = {
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80,    4, 0x80,    5, 0x80,    6, 0x80,    7, 0x80 }, 8, 8 },
+	{ {    0,    1,    2, 0x80,    3, 0x80,    4, 0x80,    5, 0x80,    6, 0x80,    7, 0x80, 0x80, 0x80 }, 7, 8 },
+	{ {    0, 0x80,    1,    2,    3, 0x80,    4, 0x80,    5, 0x80,    6, 0x80,    7, 0x80, 0x80, 0x80 }, 7, 8 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3,    4, 0x80,    5, 0x80,    6, 0x80,    7, 0x80, 0x80, 0x80 }, 7, 8 },
+	{ {    0,    1,    2,    3,    4, 0x80,    5, 0x80,    6, 0x80,    7, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3,    4,    5, 0x80,    6, 0x80,    7, 0x80, 0x80, 0x80 }, 7, 8 },
+	{ {    0,    1,    2, 0x80,    3,    4,    5, 0x80,    6, 0x80,    7, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ {    0, 0x80,    1,    2,    3,    4,    5, 0x80,    6, 0x80,    7, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80,    4,    5,    6, 0x80,    7, 0x80, 0x80, 0x80 }, 7, 8 },
+	{ {    0,    1,    2, 0x80,    3, 0x80,    4,    5,    6, 0x80,    7, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ {    0, 0x80,    1,    2,    3, 0x80,    4,    5,    6, 0x80,    7, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3,    4,    5,    6, 0x80,    7, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ {    0,    1,    2,    3,    4,    5,    6, 0x80,    7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 8 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 3 },
+	{ {    0,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ {    0, 0x80,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80,    4, 0x80,    5,    6,    7, 0x80, 0x80, 0x80 }, 7, 8 },
+	{ {    0,    1,    2, 0x80,    3, 0x80,    4, 0x80,    5,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ {    0, 0x80,    1,    2,    3, 0x80,    4, 0x80,    5,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3,    4, 0x80,    5,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ {    0,    1,    2,    3,    4, 0x80,    5,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 8 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3,    4,    5,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ {    0,    1,    2, 0x80,    3,    4,    5,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 8 },
+	{ {    0, 0x80,    1,    2,    3,    4,    5,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 8 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 4 },
+	{ {    0,    1,    2, 0x80,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 4 },
+	{ {    0, 0x80,    1,    2,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 4 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 4 },
+	{ {    0,    1,    2,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 4 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 3 },
+	{ {    0,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ {    0, 0x80,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80,    4, 0x80,    5, 0x80,    6,    7, 0x80, 0x80 }, 7, 8 },
+	{ {    0,    1,    2, 0x80,    3, 0x80,    4, 0x80,    5, 0x80,    6,    7, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ {    0, 0x80,    1,    2,    3, 0x80,    4, 0x80,    5, 0x80,    6,    7, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3,    4, 0x80,    5, 0x80,    6,    7, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ {    0,    1,    2,    3,    4, 0x80,    5, 0x80,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 8 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3,    4,    5, 0x80,    6,    7, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ {    0,    1,    2, 0x80,    3,    4,    5, 0x80,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 8 },
+	{ {    0, 0x80,    1,    2,    3,    4,    5, 0x80,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 8 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80,    4,    5,    6,    7, 0x80, 0x80, 0x80, 0x80 }, 6, 8 },
+	{ {    0,    1,    2, 0x80,    3, 0x80,    4,    5,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 8 },
+	{ {    0, 0x80,    1,    2,    3, 0x80,    4,    5,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 8 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3,    4,    5,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 8 },
+	{ {    0,    1,    2,    3,    4,    5,    6,    7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 8 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 3 },
+	{ {    0,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ {    0, 0x80,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 5 },
+	{ {    0,    1,    2, 0x80,    3, 0x80,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 5 },
+	{ {    0, 0x80,    1,    2,    3, 0x80,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 5 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 5 },
+	{ {    0,    1,    2,    3,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 5 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 5 },
+	{ {    0,    1,    2, 0x80,    3,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 5 },
+	{ {    0, 0x80,    1,    2,    3,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 5 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 4 },
+	{ {    0,    1,    2, 0x80,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 4 },
+	{ {    0, 0x80,    1,    2,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 4 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 4 },
+	{ {    0,    1,    2,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 4 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 3 },
+	{ {    0,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ {    0, 0x80,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80,    4, 0x80,    5, 0x80,    6, 0x80, 0x80, 0x80 }, 7, 7 },
+	{ {    0,    1,    2, 0x80,    3, 0x80,    4, 0x80,    5, 0x80,    6, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 7 },
+	{ {    0, 0x80,    1,    2,    3, 0x80,    4, 0x80,    5, 0x80,    6, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 7 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3,    4, 0x80,    5, 0x80,    6, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 7 },
+	{ {    0,    1,    2,    3,    4, 0x80,    5, 0x80,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 7 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3,    4,    5, 0x80,    6, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 7 },
+	{ {    0,    1,    2, 0x80,    3,    4,    5, 0x80,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 7 },
+	{ {    0, 0x80,    1,    2,    3,    4,    5, 0x80,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 7 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80,    4,    5,    6, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 7 },
+	{ {    0,    1,    2, 0x80,    3, 0x80,    4,    5,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 7 },
+	{ {    0, 0x80,    1,    2,    3, 0x80,    4,    5,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 7 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3,    4,    5,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 7 },
+	{ {    0,    1,    2,    3,    4,    5,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 7 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 3 },
+	{ {    0,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ {    0, 0x80,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80,    4, 0x80,    5,    6, 0x80, 0x80, 0x80, 0x80 }, 6, 7 },
+	{ {    0,    1,    2, 0x80,    3, 0x80,    4, 0x80,    5,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 7 },
+	{ {    0, 0x80,    1,    2,    3, 0x80,    4, 0x80,    5,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 7 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3,    4, 0x80,    5,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 7 },
+	{ {    0,    1,    2,    3,    4, 0x80,    5,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 7 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3,    4,    5,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 7 },
+	{ {    0,    1,    2, 0x80,    3,    4,    5,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 7 },
+	{ {    0, 0x80,    1,    2,    3,    4,    5,    6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 7 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 4 },
+	{ {    0,    1,    2, 0x80,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 4 },
+	{ {    0, 0x80,    1,    2,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 4 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 4 },
+	{ {    0,    1,    2,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 4 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 3 },
+	{ {    0,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ {    0, 0x80,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80,    4, 0x80,    5, 0x80, 0x80, 0x80, 0x80, 0x80 }, 6, 6 },
+	{ {    0,    1,    2, 0x80,    3, 0x80,    4, 0x80,    5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 6 },
+	{ {    0, 0x80,    1,    2,    3, 0x80,    4, 0x80,    5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 6 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3,    4, 0x80,    5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 6 },
+	{ {    0,    1,    2,    3,    4, 0x80,    5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 6 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3,    4,    5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 6 },
+	{ {    0,    1,    2, 0x80,    3,    4,    5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 6 },
+	{ {    0, 0x80,    1,    2,    3,    4,    5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 6 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80,    4,    5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 6 },
+	{ {    0,    1,    2, 0x80,    3, 0x80,    4,    5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 6 },
+	{ {    0, 0x80,    1,    2,    3, 0x80,    4,    5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 6 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3,    4,    5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 6 },
+	{ {    0,    1,    2,    3,    4,    5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 6 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 3 },
+	{ {    0,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ {    0, 0x80,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 5, 5 },
+	{ {    0,    1,    2, 0x80,    3, 0x80,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 5 },
+	{ {    0, 0x80,    1,    2,    3, 0x80,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 5 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 5 },
+	{ {    0,    1,    2,    3,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 5 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 5 },
+	{ {    0,    1,    2, 0x80,    3,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 5 },
+	{ {    0, 0x80,    1,    2,    3,    4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 5 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 4, 4 },
+	{ {    0,    1,    2, 0x80,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 4 },
+	{ {    0, 0x80,    1,    2,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 4 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 4 },
+	{ {    0,    1,    2,    3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 4 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 3, 3 },
+	{ {    0,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ {    0, 0x80,    1,    2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 3 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+	{ {    0, 0x80,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 2, 2 },
+	{ {    0,    1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 2 },
+	{ {    0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 1, 1 },
+	{ { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, 0, 0 },
+};
+
+static inline simd_ssse3 void
+vlq__short8(
+	uint64_t                *u,
+	uint8_t const           *p,
+	struct vlq__short const *t,
+	bool                     be
+) {
+	__m128i x = _mm_shuffle_epi8(
+		_mm_loadu_si128((__m128i const *)p),
+		_mm_loadu_si128((__m128i const *)t->shuffle)
+	);
+	if(be) {
+		// the first byte of 2 is the more significant, so swap those lanes
+		__m128i const s = _mm_srai_epi16(_mm_slli_epi16(x, 8), 15);
+		__m128i const y = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+		x = _mm_or_si128(_mm_and_si128(s, y), _mm_andnot_si128(s, x));
+	}
+	x = _mm_or_si128(
+		_mm_and_si128(x, _mm_set1_epi16(0x007F)),
+		_mm_srli_epi16(_mm_and_si128(x, _mm_set1_epi16(0x7F00)), 1)
+	);
+	__m128i const z  = _mm_setzero_si128();
+	__m128i const lo = _mm_unpacklo_epi16(x, z);
+	__m128i const hi = _mm_unpackhi_epi16(x, z);
+	_mm_storeu_si128((__m128i *)(u    ), _mm_unpacklo_epi32(lo, z));
+	_mm_storeu_si128((__m128i *)(u + 2), _mm_unpackhi_epi32(lo, z));
+	_mm_storeu_si128((__m128i *)(u + 4), _mm_unpacklo_epi32(hi, z));
+	_mm_storeu_si128((__m128i *)(u + 6), _mm_unpackhi_epi32(hi, z));
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+static size_t
+vlq__encode(
+	uint8_t        *p,
+	uint64_t const *u,
+	size_t          n,
+	bool            be
+) {
+	uint8_t *const q = p;
+	for(size_t i = 0; i < n; i++) {
+		uint64_t const v = u[i];
+		size_t   const k = vlqlen(v);
+		if(k <= 8) {
+			// the continuation bits go on all but the least significant group
+			// when big-endian, else on all but the most significant
+			uint64_t w = vlq__spread(v);
+			if(be) {
+				w |= VLQ__HIGHS & vlq__bytes(k) & ~UINT64_C(0xFF);
+				w  = swapbytes64(w) >> (8 * (8 - k));
+			} else {
+				w |= VLQ__HIGHS & vlq__bytes(k - 1);
+			}
+			vlq__store(p, w);
+			p += k;
+			continue;
+		}
+		if(be) {
+			for(size_t j = k; j-- > 0; ) {
+				*p++ = (uint8_t)(((v >> (7 * j)) & 0x7Fu) | (j ? 0x80u : 0u));
+			}
+		} else {
+			for(size_t j = 0; j < k; j++) {
+				*p++ = (uint8_t)(((v >> (7 * j)) & 0x7Fu) | ((j < (k - 1)) ? 0x80u : 0u));
+			}
+		}
+	}
+	return (size_t)(p - q);
+}
+
+size_t
+vlqle_encode(
+	void           *p,
+	uint64_t const *u,
+	size_t          n
+) {
+	return vlq__encode(p, u, n, false);
+}
+
+size_t
+vlqbe_encode(
+	void           *p,
+	uint64_t const *u,
+	size_t          n
+) {
+	return vlq__encode(p, u, n, true);
+}
+
+//------------------------------------------------------------------------------
+
+// one value a byte at a time, returning its length, or 0 if it is incomplete,
+// or -1 if it is too long
+static inline int
+vlq__decode1(
+	uint64_t      *u,
+	uint8_t const *p,
+	size_t         m,
+	bool           be
+) {
+	uint64_t v = 0;
+	for(size_t j = 0; (j < m) && (j < VLQ_MAX_LEN); j++) {
+		uint64_t const b = p[j] & 0x7Fu;
+		if(be) {
+			if(v >> 57) return -1;
+			v = (v << 7) | b;
+		} else {
+			if((j == (VLQ_MAX_LEN - 1)) && (b > 1)) return -1;
+			v |= b << (7 * j);
+		}
+		if(!(p[j] & 0x80u)) {
+			*u = v;
+			return (int)j + 1;
+		}
+	}
+	return (m < VLQ_MAX_LEN) ? 0 : -1;
+}
+
+static inline size_t
+vlq__decode_loop(
+	uint64_t      *u,
+	size_t        *np,
+	uint8_t const *p,
+	size_t         m,
+	bool           be,
+	bool           ssse3
+) {
+	size_t const n = *np;
+	size_t       i = 0, k = 0;
+	while((i < m) && (k < n)) {
+		// with the continuation bits of 16 bytes as a mask, a run of 1 byte
+		// values is found at once, else where each value ends, without the
+		// position of one value waiting on the bytes of the one before
+		if((i + 24) <= m) {
+			unsigned const c = vlq__mask16(p + i);
+			if((c == 0) && ((k + 16) <= n)) {
+				vlq__widen16(u + k, p + i);
+				i += 16;
+				k += 16;
+				continue;
+			}
+#if defined(SIMD_SSSE3)
+			struct vlq__short const *t = &vlq__short[c & 0xFFu];
+			if(ssse3 && (t->n > 0) && ((k + 8) <= n)) {
+				vlq__short8(u + k, p + i, t, be);
+				i += t->len;
+				k += t->n;
+				continue;
+			}
+#else
+			(void)ssse3;
+#endif
+			size_t s = 0;
+			for(unsigned e = ~c & 0xFFFFu; e && (k < n); e &= e - 1) {
+				size_t const j = (size_t)tzcount(e) + 1;
+				size_t const l = j - s;
+				if(l > 8) break;
+				uint64_t w = vlq__load(p + i + s) & (~UINT64_C(0) >> (8 * (8 - l)));
+				if(be) {
+					w = swapbytes64(w) >> (8 * (8 - l));
+				}
+				u[k++] = vlq__pack(w);
+				s = j;
+			}
+			if(s > 0) {
+				i += s;
+				continue;
+			}
+		}
+		int const l = vlq__decode1(&u[k], p + i, m - i, be);
+		if(l <= 0) {
+			if(l < 0) errno = EILSEQ;
+			break;
+		}
+		i += (size_t)l;
+		k++;
+	}
+	*np = k;
+	return i;
+}
+
+#if defined(SIMD_SSSE3)
+// the loop again, compiled for SSSE3 and taking the shuffle table path
+static simd_ssse3 size_t
+vlq__decode_ssse3(
+	uint64_t      *u,
+	size_t        *np,
+	uint8_t const *p,
+	size_t         m,
+	bool           be
+) {
+	return vlq__decode_loop(u, np, p, m, be, true);
+}
+#endif
+
+static size_t
+vlq__decode(
+	uint64_t      *u,
+	size_t        *np,
+	uint8_t const *p,
+	size_t         m,
+	bool           be
+) {
+#if defined(SIMD_SSSE3)
+	if(has_ssse3()) return vlq__decode_ssse3(u, np, p, m, be);
+#endif
+	return vlq__decode_loop(u, np, p, m, be, false);
+}
+
+size_t
+vlqle_decode(
+	uint64_t   *u,
+	size_t     *np,
+	void const *p,
+	size_t      m
+) {
+	return vlq__decode(u, np, p, m, false);
+}
+
+size_t
+vlqbe_decode(
+	uint64_t   *u,
+	size_t     *np,
+	void const *p,
+	size_t      m
+) {
+	return vlq__decode(u, np, p, m, true);
+}
+
+//------------------------------------------------------------------------------
+
+#endif//def HOL_VLQ_H__IMPLEMENTATION
@@ -335,7 +335,7 @@ XFILE *(xfopen)(char const *name, char const *mode) {
 				is_std    = true;
 				mode      = "w";
 			} else {
-				f->stream = is_pipe ? popen(name+1, mode) : fopen(name, mode);
+				f->stream = is_pipe ? popen(name+1, (*mode == 'r') ? POPEN_RB : POPEN_WB) : fopen(name, mode);
 			}
 			if(f->stream) {
 				f->is_std  = is_std;
@@ -30,6 +30,21 @@ SOFTWARE.
 
 //------------------------------------------------------------------------------
 
+// the double-word multiply and divide use the compiler's native 128-bit
+// integers, or the MSVC x64 intrinsics, when uintmax_t is 64 bits; defining
+// XTDINT_PORTABLE selects the half-word emulation everywhere
+
+#if !defined(XTDINT_PORTABLE) && (UINTMAX_MAX == UINT64_MAX)
+#	if defined(__SIZEOF_INT128__)
+#		define XTDINT__INT128  1
+#	elif defined(_MSC_VER) && (_MSC_VER >= 1920) && defined(_M_X64)
+#		include <intrin.h>
+#		define XTDINT__MSVC64  1
+#	endif
+#endif
+
+//------------------------------------------------------------------------------
+
 static inline int
 uucmp(
 	uintmax_t ah,
@@ -281,6 +296,136 @@ uurol(
 	return;
 }
 
+#if defined(XTDINT__INT128)
+
+void
+uumulu(
+	uintmax_t  ah,
+	uintmax_t  al,
+	uintmax_t  b,
+	uintmax_t *vh,
+	uintmax_t *vl
+) {
+	unsigned __int128 const x = (unsigned __int128)al * b;
+	*vl = (uintmax_t)x;
+	*vh = (ah * b) + (uintmax_t)(x >> 64);
+}
+
+void
+uumadu(
+	uintmax_t  ah,
+	uintmax_t  al,
+	uintmax_t  b,
+	uintmax_t  c,
+	uintmax_t *vh,
+	uintmax_t *vl
+) {
+	unsigned __int128 const x = ((unsigned __int128)al * b) + c;
+	*vl = (uintmax_t)x;
+	*vh = (ah * b) + (uintmax_t)(x >> 64);
+}
+
+void
+uumsbu(
+	uintmax_t  ah,
+	uintmax_t  al,
+	uintmax_t  b,
+	uintmax_t  c,
+	uintmax_t *vh,
+	uintmax_t *vl
+) {
+	unsigned __int128 const x = ((unsigned __int128)al * b) - c;
+	*vl = (uintmax_t)x;
+	*vh = (ah * b) + (uintmax_t)(x >> 64);
+}
+
+uintmax_t
+uudivu(
+	uintmax_t  ah,
+	uintmax_t  al,
+	uintmax_t  b,
+	uintmax_t *vh,
+	uintmax_t *vl
+) {
+	if(b == 0) {
+		*vh = *vl = ~UINTMAX_C(0);
+		return 0;
+	}
+	// the high remainder is less than b, so the low quotient fits a word
+	unsigned __int128 const x = ((unsigned __int128)(ah % b) << 64) | al;
+	uintmax_t         const q = (uintmax_t)(x / b);
+	*vh = ah / b;
+	*vl = q;
+	return al - (q * b);
+}
+
+#elif defined(XTDINT__MSVC64)
+
+void
+uumulu(
+	uintmax_t  ah,
+	uintmax_t  al,
+	uintmax_t  b,
+	uintmax_t *vh,
+	uintmax_t *vl
+) {
+	uintmax_t h;
+	*vl = _umul128(al, b, &h);
+	*vh = (ah * b) + h;
+}
+
+void
+uumadu(
+	uintmax_t  ah,
+	uintmax_t  al,
+	uintmax_t  b,
+	uintmax_t  c,
+	uintmax_t *vh,
+	uintmax_t *vl
+) {
+	uintmax_t h;
+	uintmax_t l = _umul128(al, b, &h);
+	h  += _addcarry_u64(0, l, c, &l);
+	*vl = l;
+	*vh = (ah * b) + h;
+}
+
+void
+uumsbu(
+	uintmax_t  ah,
+	uintmax_t  al,
+	uintmax_t  b,
+	uintmax_t  c,
+	uintmax_t *vh,
+	uintmax_t *vl
+) {
+	uintmax_t h;
+	uintmax_t l = _umul128(al, b, &h);
+	h  -= _subborrow_u64(0, l, c, &l);
+	*vl = l;
+	*vh = (ah * b) + h;
+}
+
+uintmax_t
+uudivu(
+	uintmax_t  ah,
+	uintmax_t  al,
+	uintmax_t  b,
+	uintmax_t *vh,
+	uintmax_t *vl
+) {
+	if(b == 0) {
+		*vh = *vl = ~UINTMAX_C(0);
+		return 0;
+	}
+	uintmax_t r;
+	*vl = _udiv128(ah % b, al, b, &r);
+	*vh = ah / b;
+	return r;
+}
+
+#else
+
 void
 uumulu(
 	uintmax_t  ah,
@@ -297,8 +442,9 @@ uumulu(
 		return;
 	}
 	if(is_power_of_2(b)) {
-		if(b > 1) uushl(ah, al, (int)n - 1, vh, vl);
+		if(b >  1) uushl(ah, al, (int)n - 1, vh, vl);
 		else if(b == 0) *vh = *vl = 0;
+		else       *vh = ah, *vl = al;
 		return;
 	}
 
@@ -408,6 +554,8 @@ uudivu(
 	return al % b;
 }
 
+#endif
+
 void
 uufactorial(
 	unsigned   n,
@@ -438,17 +586,19 @@ uugenperm(
 	size_t    n,
 	size_t    i[]
 ) {
-	size_t const z = n-1;
-	size_t       y = z;
-	if(y > 0) {
+	size_t o[GENPERM_MAX_PLACED];
+	size_t m = 0;
+	for(; ph && (n > 0); m++) {
 		size_t const r = uudivu(ph, pl, n, &ph, &pl);
-		uugenperm(ph, pl, z, i);
-		size_t const x = z - r;
-		for(; y > x; y--) {
-			i[y] = i[y-1];
-		}
+		n--;
+		i[genperm__place(n - r, m, o)] = n;
+	}
+	for(; pl && (n > 0); m++) {
+		size_t const r = pl % n;
+		pl /= n--;
+		i[genperm__place(n - r, m, o)] = n;
 	}
-	i[y] = z;
+	genperm__fill(n, i, m, o);
 }
 
 //------------------------------------------------------------------------------
@@ -29,6 +29,7 @@ SOFTWARE.
 #include <hol/xtdlib.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 
 //------------------------------------------------------------------------------
 
@@ -42,6 +43,17 @@ SOFTWARE.
 #	endif
 #endif
 
+// popen modes for binary pipes; POSIX popen only takes "r" or "w", and its
+// pipes are binary anyway
+
+#ifdef _WIN32
+#	define POPEN_RB  "rb"
+#	define POPEN_WB  "wb"
+#else
+#	define POPEN_RB  "r"
+#	define POPEN_WB  "w"
+#endif
+
 //------------------------------------------------------------------------------
 
 struct do__printf {
@@ -95,6 +107,9 @@ extern char *loadrecursive(char const *file, char const *sep, size_t *np, size_t
 #define loadrecursive(loadrecursive__file,loadrecursive__sep,loadrecursive__np,loadrecursive__zp,...) \
 	(loadrecursive)((loadrecursive__file),(loadrecursive__sep),(loadrecursive__np),(loadrecursive__zp),__VA_ARGS__+0)
 
+extern void *mapfile(char const *file, size_t *zp);
+extern void  unmapfile(void *p, size_t z);
+
 extern void errorf(char const *fmt, ...);
 
 extern void perror__with_file_and_line(char const *file, int line, char const *cs);
@@ -157,6 +172,166 @@ snprint_time_interval_s(
 
 //------------------------------------------------------------------------------
 
+// FMTBUF: buffered number output; values are converted straight into a large
+//         buffer, decimal two digits at a time from a digit-pair table, and
+//         the buffer is flushed with a single fwrite. A write error is kept,
+//         and reported by fmtbuf_flush.
+
+#ifndef FMTBUF_SIZE
+#	define FMTBUF_SIZE  (64 Ki)
+#endif
+
+struct fmtbuf {
+	FILE  *out;
+	size_t n;
+	bool   error;
+	char   b[FMTBUF_SIZE];
+};
+
+extern char     const fmtbuf__digits[200];
+extern char     const fmtbuf__xdigits[2][16];
+extern uint64_t const fmtbuf__pow10[20];
+
+extern int fmtbuf_flush(struct fmtbuf *fb);
+extern int fmtbuf_write(struct fmtbuf *fb, void const *p, size_t n);
+
+static inline void
+fmtbuf_init(
+	struct fmtbuf *fb,
+	FILE          *out
+) {
+	fb->out   = out;
+	fb->n     = 0;
+	fb->error = false;
+}
+
+// room for n <= FMTBUF_SIZE chars, written directly then kept by fmtbuf_advance
+static inline char *
+fmtbuf_reserve(
+	struct fmtbuf *fb,
+	size_t         n
+) {
+	if(unlikely((FMTBUF_SIZE - fb->n) < n)) fmtbuf_flush(fb);
+	return fb->b + fb->n;
+}
+
+static inline void
+fmtbuf_advance(
+	struct fmtbuf *fb,
+	size_t         n
+) {
+	fb->n += n;
+}
+
+static inline int
+fmtbuf_putc(
+	struct fmtbuf *fb,
+	int            c
+) {
+	*fmtbuf_reserve(fb, 1) = (char)c;
+	fb->n++;
+	return (unsigned char)c;
+}
+
+// moves what src holds to the end of fb, leaving src empty
+static inline int
+fmtbuf_move(
+	struct fmtbuf *fb,
+	struct fmtbuf *src
+) {
+	int const n = fmtbuf_write(fb, src->b, src->n);
+	src->n = 0;
+	return n;
+}
+
+static inline int
+fmtbuf_puts(
+	struct fmtbuf *fb,
+	char const    *cs
+) {
+	return fmtbuf_write(fb, cs, strlen(cs));
+}
+
+static inline void
+fmtbuf_pad(
+	struct fmtbuf *fb,
+	int            c,
+	size_t         n
+) {
+	for(size_t k; n > 0; n -= k) {
+		k = (n < 64) ? n : 64;
+		memset(fmtbuf_reserve(fb, k), c, k);
+		fb->n += k;
+	}
+}
+
+// number of decimal digits, from an estimate off the bit length
+static inline int
+fmtbuf_u64len(
+	uint64_t v
+) {
+	int const t = (msbit(v | 1) * 1233) >> 12;
+	return t + 1 - (v < fmtbuf__pow10[t]);
+}
+
+static inline int
+fmtbuf_u64xlen(
+	uint64_t v
+) {
+	return (msbit(v | 1) + 3) / 4;
+}
+
+static inline int
+fmtbuf_u64dec_padded(
+	struct fmtbuf *fb,
+	uint64_t       v,
+	int            width
+) {
+	int const n = fmtbuf_u64len(v);
+	if(width > n) fmtbuf_pad(fb, '0', width - n);
+
+	char *p = fmtbuf_reserve(fb, n) + n;
+	for(; v >= 100; v /= 100) {
+		p -= 2;
+		memcpy(p, &fmtbuf__digits[2 * (v % 100)], 2);
+	}
+	if(v >= 10) {
+		memcpy(p - 2, &fmtbuf__digits[2 * v], 2);
+	} else {
+		p[-1] = (char)('0' + v);
+	}
+	fb->n += n;
+	return (width > n) ? width : n;
+}
+
+static inline int
+fmtbuf__hex(
+	struct fmtbuf *fb,
+	uint64_t       v,
+	int            width,
+	char const    *xdigits
+) {
+	int const n = fmtbuf_u64xlen(v);
+	if(width > n) fmtbuf_pad(fb, '0', width - n);
+
+	char *p = fmtbuf_reserve(fb, n) + n;
+	for(int i = 0; i < n; i++, v >>= 4) {
+		*--p = xdigits[v & 15];
+	}
+	fb->n += n;
+	return (width > n) ? width : n;
+}
+
+static inline int fmtbuf_u64dec(struct fmtbuf *fb, uint64_t v) { return fmtbuf_u64dec_padded(fb, v, 0); }
+
+static inline int fmtbuf_u64hex_padded(struct fmtbuf *fb, uint64_t v, int width) { return fmtbuf__hex(fb, v, width, fmtbuf__xdigits[0]); }
+static inline int fmtbuf_u64HEX_padded(struct fmtbuf *fb, uint64_t v, int width) { return fmtbuf__hex(fb, v, width, fmtbuf__xdigits[1]); }
+
+static inline int fmtbuf_u64hex(struct fmtbuf *fb, uint64_t v) { return fmtbuf_u64hex_padded(fb, v, 0); }
+static inline int fmtbuf_u64HEX(struct fmtbuf *fb, uint64_t v) { return fmtbuf_u64HEX_padded(fb, v, 0); }
+
+//------------------------------------------------------------------------------
+
 #endif//ndef HOL_XTDIO_H__INCLUDED
 
 //------------------------------------------------------------------------------
@@ -584,6 +759,92 @@ char *
 
 //------------------------------------------------------------------------------
 
+#include <errno.h>
+#ifdef _WIN32
+// every tool sees this, so keep out the rpc headers' small, and min and max
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+void *
+mapfile(
+	char const *file,
+	size_t     *zp
+) {
+	void  *p = NULL;
+	size_t z = 0;
+	HANDLE h = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(h != INVALID_HANDLE_VALUE) {
+		LARGE_INTEGER l;
+		if(GetFileSizeEx(h, &l) && (l.QuadPart > 0) && ((uint64_t)l.QuadPart <= SIZE_MAX)) {
+			HANDLE m = CreateFileMappingA(h, NULL, PAGE_READONLY, 0, 0, NULL);
+			if(m) {
+				p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+				if(p) z = (size_t)l.QuadPart;
+				CloseHandle(m);
+			}
+		}
+		CloseHandle(h);
+	}
+	if(!p) errno = ENOENT;
+	if(zp) *zp = z;
+	return p;
+}
+
+void
+unmapfile(
+	void  *p,
+	size_t z
+) {
+	(void)z;
+	if(p) UnmapViewOfFile(p);
+}
+
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+void *
+mapfile(
+	char const *file,
+	size_t     *zp
+) {
+	void  *p = NULL;
+	size_t z = 0;
+	int    d = open(file, O_RDONLY);
+	if(d >= 0) {
+		struct stat st;
+		if((fstat(d, &st) == 0) && (st.st_size > 0) && ((uintmax_t)st.st_size <= SIZE_MAX)) {
+			p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, d, 0);
+			if(p != MAP_FAILED) z = (size_t)st.st_size;
+			else p = NULL;
+		} else {
+			errno = EINVAL;
+		}
+		close(d);
+	}
+	if(zp) *zp = z;
+	return p;
+}
+
+void
+unmapfile(
+	void  *p,
+	size_t z
+) {
+	if(p) munmap(p, z);
+}
+
+#endif//def _WIN32
+
+//------------------------------------------------------------------------------
+
 void
 errorf(
 	char const *fmt,
@@ -642,4 +903,80 @@ char const *getfilename(char const *filepath, int *baselenp) {
 
 //------------------------------------------------------------------------------
 
+char const fmtbuf__digits[200] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+char const fmtbuf__xdigits[2][16] = {
+	{ '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' },
+	{ '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' },
+};
+
+// fmtbuf__pow10[0] is 0, so that 0 has one digit
+uint64_t const fmtbuf__pow10[20] = {
+	UINT64_C(0),
+	UINT64_C(10),
+	UINT64_C(100),
+	UINT64_C(1000),
+	UINT64_C(10000),
+	UINT64_C(100000),
+	UINT64_C(1000000),
+	UINT64_C(10000000),
+	UINT64_C(100000000),
+	UINT64_C(1000000000),
+	UINT64_C(10000000000),
+	UINT64_C(100000000000),
+	UINT64_C(1000000000000),
+	UINT64_C(10000000000000),
+	UINT64_C(100000000000000),
+	UINT64_C(1000000000000000),
+	UINT64_C(10000000000000000),
+	UINT64_C(100000000000000000),
+	UINT64_C(1000000000000000000),
+	UINT64_C(10000000000000000000),
+};
+
+int
+fmtbuf_flush(
+	struct fmtbuf *fb
+) {
+	if(fb->n > 0) {
+		if(!fb->error && (fwrite(fb->b, 1, fb->n, fb->out) != fb->n)) {
+			fb->error = true;
+		}
+		fb->n = 0;
+	}
+	return fb->error ? EOF : 0;
+}
+
+int
+fmtbuf_write(
+	struct fmtbuf *fb,
+	void const    *p,
+	size_t         n
+) {
+	if((FMTBUF_SIZE - fb->n) < n) {
+		fmtbuf_flush(fb);
+		if(n >= FMTBUF_SIZE) {
+			if(!fb->error && (fwrite(p, 1, n, fb->out) != n)) {
+				fb->error = true;
+			}
+			return fb->error ? EOF : (int)n;
+		}
+	}
+	memcpy(fb->b + fb->n, p, n);
+	fb->n += n;
+	return (int)n;
+}
+
+//------------------------------------------------------------------------------
+
 #endif//def HOL_XTDIO_H__IMPLEMENTATION
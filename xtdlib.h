@@ -525,10 +525,50 @@ extern int ndigits(unsigned long long n);
 extern uint64_t factorial(unsigned n);
 
 extern void     genperm  (uint64_t p, size_t n, size_t i[]);
+extern bool     genperm_next(size_t n, size_t i[], size_t r[]);
 extern uint8_t  genperm4 (uint8_t p);
 extern uint32_t genperm8 (uint32_t p);
 extern uint64_t genperm16(uint64_t p);
 
+// unranking places the elements from the largest down, each in the x-th slot
+// not yet taken; once the rank is exhausted every remaining x selects the last
+// free slot, so the rest of the elements simply fill the free slots in order,
+// and at most 64 slots (o[]) are ever taken before that happens
+
+#define GENPERM_MAX_PLACED  64
+
+static inline size_t
+genperm__place(
+	size_t x,
+	size_t m,
+	size_t o[]
+) {
+	size_t j = 0;
+	for(; (j < m) && (o[j] <= x); j++, x++)
+		;
+	for(size_t k = m; k > j; k--) {
+		o[k] = o[k-1];
+	}
+	o[j] = x;
+	return x;
+}
+
+static inline void
+genperm__fill(
+	size_t       k,
+	size_t       i[],
+	size_t       m,
+	size_t const o[]
+) {
+	for(size_t y = 0, j = 0, e = 0; e < k; y++) {
+		if((j < m) && (o[j] == y)) {
+			j++;
+		} else {
+			i[y] = e++;
+		}
+	}
+}
+
 //------------------------------------------------------------------------------
 
 #endif//ndef HOL_XTDLIB_H__INCLUDED
@@ -594,16 +634,41 @@ genperm(
 	size_t   n,
 	size_t   i[]
 ) {
-	size_t const z = n-1;
-	size_t       y = z;
-	if(y > 0) {
-		genperm(p / n, z, i);
-		size_t const x = z - (p % n);
-		for(; y > x; y--) {
-			i[y] = i[y-1];
+	size_t o[GENPERM_MAX_PLACED];
+	size_t m = 0;
+	for(; p && (n > 0); m++) {
+		size_t const r = p % n;
+		p /= n--;
+		i[genperm__place(n - r, m, o)] = n;
+	}
+	genperm__fill(n, i, m, o);
+}
+
+// steps i[] to the permutation of the next rank, in O(1) amortized; r[k] is
+// the rank digit of element k (p / n!/(k+1)! % (k+1)), which is how far k sits
+// from the end of i[0..k], as all elements above k are in place at the end;
+// returns false on wrapping around to rank 0
+bool
+genperm_next(
+	size_t n,
+	size_t i[],
+	size_t r[]
+) {
+	for(size_t k = n; k-- > 0; ) {
+		size_t const x = k - r[k];
+		if(r[k] < k) {
+			i[x] = i[x-1];
+			i[x-1] = k;
+			r[k]++;
+			return true;
+		}
+		for(size_t y = 0; y < k; y++) {
+			i[y] = i[y+1];
 		}
+		i[k] = k;
+		r[k] = 0;
 	}
-	i[y] = z;
+	return false;
 }
 
 #define XTDLIB__GENPERM(XTDLIB__GENPERM__type,XTDLIB__GENPERM__bits,XTDLIB__GENPERM__states) \